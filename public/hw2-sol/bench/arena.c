@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define ARENA_HEADER 16  // chunk link, padded so blocks stay 16-byte aligned
+
+struct arena ar_new(void) {
+  struct arena new_arena = {
+    .chunks = NULL,
+    .cursor = NULL,
+    .left = 0};
+  for (int c = 0; c < ARENA_CLASSES; ++c) {
+    new_arena.free_list[c] = NULL;
+  }
+  return new_arena;
+}
+
+void ar_delete(struct arena *arena) {
+  while (arena->chunks != NULL) {
+    void *next = *(void**) arena->chunks;
+    free(arena->chunks);
+    arena->chunks = next;
+  }
+  *arena = ar_new();
+}
+
+/*
+ * Size of the blocks of class c: 16, 32, 48, 64, then 80, 96, 112, 128, 160, 192, ... Every class is
+ * a multiple of ARENA_MIN_BLOCK, which keeps bump-allocated blocks aligned.
+ */
+static size_t ar_class_size(const int c) {
+  if (c < 4) {
+    return (size_t) ARENA_MIN_BLOCK * (c + 1);
+  }
+  const size_t base = (size_t) 4 * ARENA_MIN_BLOCK << ((c - 4) / 4);
+  return base + base / 4 * ((c - 4) % 4 + 1);
+}
+
+/*
+ * Index of the smallest size class holding bytes, ARENA_CLASSES if none does.
+ */
+static int ar_class(const size_t bytes) {
+  int c = 0;
+  while (c < ARENA_CLASSES && ar_class_size(c) < bytes) {
+    c++;
+  }
+  return c;
+}
+
+/*
+ * Links a new chunk with room for bytes after its header and returns that room.
+ */
+static char* ar_add_chunk(struct arena *arena, const size_t bytes) {
+  char *chunk = (char*) malloc(ARENA_HEADER + bytes);
+  if (chunk == NULL) {
+    return NULL;
+  }
+  *(void**) chunk = arena->chunks;
+  arena->chunks = chunk;
+  return chunk + ARENA_HEADER;
+}
+
+void* ar_alloc(struct arena *arena, const size_t bytes) {
+  const int c = ar_class(bytes);
+  if (c == ARENA_CLASSES) {
+    return ar_add_chunk(arena, bytes);
+  }
+  if (arena->free_list[c] != NULL) {
+    void *block = arena->free_list[c];
+    arena->free_list[c] = *(void**) block;
+    return block;
+  }
+  const size_t block = ar_class_size(c);
+  if (block > ARENA_CHUNK / 2) {
+    return ar_add_chunk(arena, block);
+  }
+  if (arena->left < block) {
+    // The tail of the old chunk is abandoned; it is smaller than the block, so at most half a chunk
+    char *room = ar_add_chunk(arena, ARENA_CHUNK - ARENA_HEADER);
+    if (room == NULL) {
+      return NULL;
+    }
+    arena->cursor = room;
+    arena->left = ARENA_CHUNK - ARENA_HEADER;
+  }
+  void *result = arena->cursor;
+  arena->cursor += block;
+  arena->left -= block;
+  return result;
+}
+
+void ar_free(struct arena *arena, void *block, const size_t bytes) {
+  const int c = ar_class(bytes);
+  if (block == NULL || c == ARENA_CLASSES) {
+    return;
+  }
+  *(void**) block = arena->free_list[c];
+  arena->free_list[c] = block;
+}
+
+/*
+ * Number of elements that fit in the block ar_alloc returns for capacity elements. Reporting
+ * the whole block as capacity is safe for ar_free, which only needs a size no larger than the block.
+ */
+static size_t ar_fit(const size_t capacity, const size_t element_size) {
+  const int c = ar_class(capacity * element_size);
+  return c == ARENA_CLASSES ? capacity : ar_class_size(c) / element_size;
+}
+
+struct arena_array aa_new(struct arena *arena, const size_t element_size, size_t capacity) {
+  capacity = ar_fit(capacity > 0 ? capacity : 1, element_size);
+  struct arena_array new_arr = {
+    .data = (char*) ar_alloc(arena, capacity * element_size),
+    .size = 0,
+    .capacity = capacity,
+    .element_size = element_size,
+    .arena = arena};
+  return new_arr;
+}
+
+int aa_push_back(struct arena_array *arr, const void *new_element) {
+  if (arr->size == arr->capacity) {
+    const size_t old_bytes = arr->capacity * arr->element_size;
+    arr->capacity = ar_fit(arr->capacity << 1, arr->element_size);
+    char *grown = (char*) ar_alloc(arr->arena, arr->capacity * arr->element_size);
+    if (grown == NULL) {
+      return -1;
+    }
+    memcpy(grown, arr->data, arr->size * arr->element_size);
+    ar_free(arr->arena, arr->data, old_bytes);
+    arr->data = grown;
+  }
+  memcpy(arr->data + arr->size * arr->element_size, new_element, arr->element_size);
+  arr->size++;
+  return 0;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <stddef.h>
+
+/*
+ * The size-class arena measured by bench/array_arena. It is kept out of cds: the engine stores slot
+ * bicycles inline and the tree as one CSR array, so it makes only a few dozen allocations and has
+ * nothing to put in an arena.
+ */
+
+#define ARENA_CHUNK (1 << 20)
+#define ARENA_MIN_BLOCK 16
+#define ARENA_CLASSES 60  // 16, 32, 48, 64, then four classes per doubling up to 1 MiB
+
+/*
+ * Storage for many small arrays that live until the same teardown. Blocks come in size classes
+ * a quarter of a power of two apart, so rounding wastes at most 25%, and are cut from
+ * ARENA_CHUNK-byte chunks; a released block goes on the free list of its class for the next
+ * array of that size. Blocks of more than half a chunk get a chunk of their own. Nothing is
+ * returned to the system before ar_delete, which frees every chunk at once.
+ */
+struct arena {
+  void *chunks;  // singly linked through the first word of each chunk
+  char *cursor;
+  size_t left;   // bytes after cursor in the newest chunk
+  void *free_list[ARENA_CLASSES];
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                          ARENA NEW
+ * 
+ * Description: Creates an empty arena.
+ * 
+ * Arguments: None.
+ *
+ * Returns: A newly created struct arena instance.
+ * 
+ * Notes: No memory is taken until the first block is allocated.
+ *********************************************************************************************************
+ */
+struct arena ar_new(void);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        ARENA DELETE
+ * 
+ * Description: Frees every chunk of an arena.
+ * 
+ * Arguments: arena   Pointer to the arena to delete.
+ *
+ * Returns: void
+ * 
+ * Notes: Every block and every array created in the arena becomes invalid; the arrays need not be
+ *        deleted first.
+ *********************************************************************************************************
+ */
+void ar_delete(struct arena *arena);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        ARENA ALLOC
+ * 
+ * Description: Takes a block of at least the given size from an arena.
+ * 
+ * Arguments: arena   Pointer to the arena.
+ *            bytes   The size needed.
+ *
+ * Returns: Pointer to the block, or NULL on memory allocation failure.
+ * 
+ * Notes: The block is rounded up to its size class and aligned to ARENA_MIN_BLOCK bytes.
+ *********************************************************************************************************
+ */
+void* ar_alloc(struct arena *arena, size_t bytes);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        ARENA FREE
+ * 
+ * Description: Gives a block back to its size class.
+ * 
+ * Arguments: arena   Pointer to the arena.
+ *            block   The block, as returned by ar_alloc.
+ *            bytes   The size it was allocated with.
+ *
+ * Returns: void
+ * 
+ * Notes: Blocks larger than the largest class stay with their chunk until ar_delete.
+ *********************************************************************************************************
+ */
+void ar_free(struct arena *arena, void *block, size_t bytes);
+
+/*
+ * A growable array whose buffer lives in an arena, the arena counterpart of struct cds_array.
+ */
+struct arena_array {
+  char *data;
+  size_t size, capacity, element_size;
+  struct arena *arena;
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       ARENA ARRAY NEW
+ * 
+ * Description: Creates an empty array whose buffer is taken from an arena.
+ * 
+ * Arguments: arena          Pointer to the arena that holds the buffer.
+ *            element_size   The size of each element.
+ *            capacity       The initial capacity, e.g. the largest size the array is expected to reach.
+ *
+ * Returns: A newly created struct arena_array instance.
+ * 
+ * Notes: The capacity is rounded up to fill its size class. ar_delete releases the buffer together
+ *        with the arena.
+ *********************************************************************************************************
+ */
+struct arena_array aa_new(struct arena *arena, size_t element_size, size_t capacity);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    ARENA ARRAY PUSH BACK
+ * 
+ * Description: Appends a copy of an element to an array.
+ * 
+ * Arguments: arr           Pointer to the array.
+ *            new_element   Pointer to the element to copy.
+ *
+ * Returns: 0 on success, -1 on memory allocation failure.
+ * 
+ * Notes: Growing moves the elements to a block of the next size class and releases the old block to
+ *        the arena.
+ *********************************************************************************************************
+ */
+int aa_push_back(struct arena_array *arr, const void *new_element);
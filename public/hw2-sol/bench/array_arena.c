@@ -0,0 +1,119 @@
+/*
+ * Microbenchmark: building and tearing down one cds_array per parking slot and one per vertex's
+ * edge list, the layout the original solution used, with every buffer from malloc/realloc (ca_new)
+ * or from a shared arena (aa_new, sized to hold twice the slot capacity, released by one
+ * ar_delete).
+ * Peak resident memory is reported as well, so run each mode in its own process.
+ *
+ * Build: make bench
+ * Usage: bench/array_arena malloc|arena [slots] [max_capacity]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "../cds.h"
+#include "arena.h"
+
+// The shapes the original solution stored: a bicycle and an edge of the tree
+struct bench_bicycle {
+  long long p, q;
+  int owner;
+};
+
+struct bench_edge {
+  size_t to;
+  long long dis;
+};
+
+/*
+ * The arrays of one run: n edge lists then n slots, from malloc or from the arena.
+ */
+struct bench_store {
+  bool use_arena;
+  struct cds_array *heap;
+  struct arena_array *pooled;
+  struct arena arena;
+};
+
+static void bench_new(struct bench_store *store, size_t i, size_t element_size, size_t capacity) {
+  if (store->use_arena) {
+    store->pooled[i] = aa_new(&store->arena, element_size, capacity);
+  } else {
+    store->heap[i] = ca_new(element_size);
+  }
+}
+
+static void bench_push(struct bench_store *store, size_t i, const void *element) {
+  if (store->use_arena) {
+    aa_push_back(&store->pooled[i], element);
+  } else {
+    ca_push_back(&store->heap[i], element);
+  }
+}
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || (strcmp(argv[1], "malloc") != 0 && strcmp(argv[1], "arena") != 0)) {
+    fprintf(stderr, "usage: %s malloc|arena [slots] [max_capacity]\n", argv[0]);
+    return 1;
+  }
+  const bool use_arena = strcmp(argv[1], "arena") == 0;
+  const size_t n = argc > 2 ? strtoull(argv[2], NULL, 10) : 300000;
+  const size_t max_capacity = argc > 3 ? strtoull(argv[3], NULL, 10) : 15;
+  struct bench_store store = {
+    .use_arena = use_arena,
+    .heap = use_arena ? NULL : (struct cds_array*) malloc(sizeof(struct cds_array) * 2 * n),
+    .pooled = use_arena ? (struct arena_array*) malloc(sizeof(struct arena_array) * 2 * n) : NULL,
+    .arena = ar_new()};
+  srand(11);
+
+  const double start = seconds();
+  // A random tree: vertex v > 0 hangs off a random earlier vertex
+  for (size_t v = 0; v < n; ++v) {
+    bench_new(&store, v, sizeof(struct bench_edge), 1);
+    if (v > 0) {
+      const size_t u = (size_t) rand() % v;
+      struct bench_edge down = { .to = v, .dis = 1 }, up = { .to = u, .dis = 1 };
+      bench_push(&store, u, &down);
+      bench_push(&store, v, &up);
+    }
+  }
+  // Each slot fills to somewhere between empty and twice its capacity, as PARK and MOVE leave it
+  size_t parked = 0;
+  for (size_t v = 0; v < n; ++v) {
+    const size_t capacity = 1 + (size_t) rand() % max_capacity;
+    bench_new(&store, n + v, sizeof(struct bench_bicycle), capacity);
+    const size_t count = (size_t) rand() % (2 * capacity + 1);
+    for (size_t i = 0; i < count; ++i) {
+      struct bench_bicycle bicycle = { .p = (long long) i, .q = 1, .owner = (int) parked++ };
+      bench_push(&store, n + v, &bicycle);
+    }
+  }
+  const double built = seconds();
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  if (use_arena) {
+    ar_delete(&store.arena);
+  } else {
+    for (size_t i = 0; i < 2 * n; ++i) {
+      ca_delete(&store.heap[i]);
+    }
+  }
+  const double done = seconds();
+
+  printf("%s: %zu slots, %zu bicycles, build %.3f s, teardown %.3f s, peak RSS %ld KiB\n",
+      argv[1], n, parked, built - start, done - built, usage.ru_maxrss);
+  free(store.heap);
+  free(store.pooled);
+  return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * Microbenchmark: r_cmp and r_avg on positions from deep midpoint chains (denominators up to 2^58),
+ * checked against the exact dyadic kernels. Build it with and without -DRATIONAL_FAST to see what
+ * the 128-bit path costs and how often the 64-bit path is wrong.
+ *
+ * Build: make bench (produces bench/rational_chain and bench/rational_chain_fast)
+ * Usage: bench/rational_chain [positions] [rounds]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../rational.h"
+#include "../dyadic.h"
+
+#define MAX_DEPTH 58
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Walks a random midpoint chain of the given depth between two neighbouring integers.
+ */
+static struct dyadic chain(int depth) {
+  const long long whole = 1 + rand() % 14;
+  struct dyadic left = d_from(whole), right = d_from(whole + 1), mid = left;
+  for (int i = 0; i < depth; ++i) {
+    mid = d_mid(left, right);
+    if (rand() & 1) {
+      left = mid;
+    } else {
+      right = mid;
+    }
+  }
+  return mid;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 4096;
+  const size_t rounds = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000;
+  struct dyadic *d = (struct dyadic*) malloc(sizeof(struct dyadic) * n);
+  struct rational *r = (struct rational*) malloc(sizeof(struct rational) * n);
+  srand(7);
+  for (size_t i = 0; i < n; ++i) {
+    d[i] = chain(rand() % (MAX_DEPTH + 1));
+    r[i] = d_to_rational(d[i]);
+  }
+
+  size_t wrong_cmp = 0, wrong_avg = 0;
+  for (size_t i = 0; i + 1 < n; ++i) {
+    wrong_cmp += r_cmp(&r[i], &r[i + 1]) != d_cmp(&d[i], &d[i + 1]);
+    struct rational avg = r_avg(r[i], r[i + 1]);
+    struct rational expected = d_to_rational(d_mid(d[i], d[i + 1]));
+    wrong_avg += avg.p != expected.p || avg.q != expected.q;
+  }
+
+  long long sink = 0;
+  double start = seconds();
+  for (size_t k = 0; k < rounds; ++k) {
+    for (size_t i = 0; i + 1 < n; ++i) {
+      sink += r_cmp(&r[i], &r[i + 1]);
+    }
+  }
+  const double cmp_time = seconds() - start;
+  start = seconds();
+  for (size_t k = 0; k < rounds; ++k) {
+    for (size_t i = 0; i + 1 < n; ++i) {
+      sink += r_avg(r[i], r[i + 1]).q;
+    }
+  }
+  const double avg_time = seconds() - start;
+  start = seconds();
+  for (size_t k = 0; k < rounds; ++k) {
+    for (size_t i = 0; i + 1 < n; ++i) {
+      sink += d_cmp(&d[i], &d[i + 1]);
+    }
+  }
+  const double d_cmp_time = seconds() - start;
+  start = seconds();
+  for (size_t k = 0; k < rounds; ++k) {
+    for (size_t i = 0; i + 1 < n; ++i) {
+      sink += (long long) d_mid(d[i], d[i + 1]).frac;
+    }
+  }
+  const double d_mid_time = seconds() - start;
+
+  const double ops = (double) rounds * (n - 1);
+#ifdef RATIONAL_FAST
+  printf("rational arithmetic: fast (64-bit)\n");
+#else
+  printf("rational arithmetic: checked (128-bit)\n");
+#endif
+  printf("r_cmp  %8.2f ns/op, %zu of %zu wrong\n", cmp_time * 1e9 / ops, wrong_cmp, n - 1);
+  printf("r_avg  %8.2f ns/op, %zu of %zu wrong\n", avg_time * 1e9 / ops, wrong_avg, n - 1);
+  printf("d_cmp  %8.2f ns/op (reference)\n", d_cmp_time * 1e9 / ops);
+  printf("d_mid  %8.2f ns/op (reference)\n", d_mid_time * 1e9 / ops);
+  fprintf(stderr, "checksum %lld\n", sink);
+  free(d);
+  free(r);
+  return 0;
+}
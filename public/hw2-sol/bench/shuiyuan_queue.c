@@ -0,0 +1,102 @@
+/*
+ * Microbenchmark: Shuiyuan traffic of CLEAR bursts followed by FETCHes, comparing the generic
+ * cds_heap (si_cmp callback, one pop per fetched bicycle) with the radix heap and its batch drain,
+ * and with the count-only ready_count of -DSHUIYUAN_COUNT_ONLY builds.
+ *
+ * Build: make bench
+ * Usage: bench/shuiyuan_queue [rounds] [burst] [step]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../cds.h"
+#include "../radix_heap.h"
+#include "../ready_count.h"
+
+static int si_cmp(const void *a, const void *b) {
+  const struct sy_info *ca = (const struct sy_info*) a;
+  const struct sy_info *cb = (const struct sy_info*) b;
+  if (ca->t != cb->t) {
+    return ca->t < cb->t ? -1 : 1;
+  }
+  return ca->owner < cb->owner ? -1 : ca->owner > cb->owner;
+}
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t rounds = argc > 1 ? strtoull(argv[1], NULL, 10) : 20000;
+  const size_t burst = argc > 2 ? strtoull(argv[2], NULL, 10) : 300;
+  const long long step = argc > 3 ? strtoll(argv[3], NULL, 10) : 500;
+  // Each round clears `burst` bicycles at time t and fetches at t + 1; delays are up to 10^6 and
+  // rounds are 1 to 2 * step apart
+  long long *delay = (long long*) malloc(sizeof(long long) * burst);
+  long long *when = (long long*) malloc(sizeof(long long) * rounds);
+  srand(7);
+  for (size_t i = 0; i < burst; ++i) {
+    delay[i] = rand() % 1000001;
+  }
+  for (size_t r = 0; r < rounds; ++r) {
+    when[r] = (r > 0 ? when[r - 1] + 2 : 0) + rand() % (2 * step);
+  }
+
+  size_t fetched_heap = 0, fetched_radix = 0, fetched_count = 0;
+  double start = seconds();
+  struct cds_heap heap = ch_new(sizeof(struct sy_info), si_cmp);
+  for (size_t r = 0; r < rounds; ++r) {
+    const long long t = when[r];
+    for (size_t i = 0; i < burst; ++i) {
+      struct sy_info info = { .owner = (int) i, .t = t + delay[(i + r) % burst] };
+      ch_push(&heap, &info);
+    }
+    while (ch_size(&heap) > 0 && ((struct sy_info*) ch_top(&heap))->t <= t + 1) {
+      fetched_heap++;
+      ch_pop(&heap);
+    }
+  }
+  ch_delete(&heap);
+  const double heap_time = seconds() - start;
+
+  start = seconds();
+  struct radix_heap radix = rh_new();
+  for (size_t r = 0; r < rounds; ++r) {
+    const long long t = when[r];
+    for (size_t i = 0; i < burst; ++i) {
+      struct sy_info info = { .owner = (int) i, .t = t + delay[(i + r) % burst] };
+      rh_push(&radix, info);
+    }
+    fetched_radix += rh_drain(&radix, t + 1);
+  }
+  rh_delete(&radix);
+  const double radix_time = seconds() - start;
+
+  start = seconds();
+  struct ready_count count = rc_new();
+  for (size_t r = 0; r < rounds; ++r) {
+    const long long t = when[r];
+    for (size_t i = 0; i < burst; ++i) {
+      rc_push(&count, t, t + delay[(i + r) % burst]);
+    }
+    fetched_count += rc_drain(&count, t + 1);
+  }
+  rc_delete(&count);
+  const double count_time = seconds() - start;
+
+  if (fetched_heap != fetched_radix || fetched_heap != fetched_count) {
+    fprintf(stderr, "queues disagree: %zu, %zu, %zu\n", fetched_heap, fetched_radix,
+        fetched_count);
+    return 1;
+  }
+  printf("%zu rounds of %zu bicycles, %zu fetched\n", rounds, burst, fetched_heap);
+  printf("cds_heap   : %.3f s\n", heap_time);
+  printf("radix heap : %.3f s (%.2fx)\n", radix_time, heap_time / radix_time);
+  printf("count only : %.3f s (%.2fx)\n", count_time, heap_time / count_time);
+  free(delay);
+  free(when);
+  return 0;
+}
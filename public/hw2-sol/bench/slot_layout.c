@@ -0,0 +1,89 @@
+/*
+ * Microbenchmark: "first bicycle with location > target" over n full parking slots, comparing the
+ * former array-of-structs layout (struct bicycle[], r_cmp per element) with the lane search of
+ * struct ps (ps_upper_bound).
+ *
+ * Build: make bench [CFLAGS="-O2 -mavx2"]
+ * Usage: bench/slot_layout [slots] [queries]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../rational.h"
+#include "../dyadic.h"
+#include "../bicycle.h"
+
+struct aos_slot {
+  struct bicycle bicycles[PS_MAX_BICYCLES];
+  size_t size;
+};
+
+static size_t aos_upper_bound(struct aos_slot *slot, long long position) {
+  struct rational target = r_from(position);
+  size_t i = 0;
+  while (i < slot->size && r_cmp(&slot->bicycles[i].location, &target) <= 0) {
+    ++i;
+  }
+  return i;
+}
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 300000;
+  const size_t queries = argc > 2 ? strtoull(argv[2], NULL, 10) : 10000000;
+  struct ps *soa = (struct ps*) aligned_alloc(PS_ALIGNMENT, sizeof(struct ps) * n);
+  struct aos_slot *aos = (struct aos_slot*) malloc(sizeof(struct aos_slot) * n);
+  struct ps_record records[PS_MAX_BICYCLES];
+  srand(7);
+
+  // Fill every slot to 2 * PS_MAX_CAPACITY bicycles through the real parking policy
+  for (size_t i = 0; i < n; ++i) {
+    soa[i] = ps_new(PS_MAX_CAPACITY);
+    for (int owner = 0; owner < PS_MAX_BICYCLES; ++owner) {
+      ps_insert(&soa[i], owner, 1 + rand() % PS_MAX_CAPACITY, records);
+    }
+    aos[i].size = soa[i].size;
+    for (size_t j = 0; j < soa[i].size; ++j) {
+      struct dyadic location = { .whole = soa[i].whole[j], .frac = soa[i].frac[j] };
+      aos[i].bicycles[j].location = d_to_rational(location);
+      aos[i].bicycles[j].owner = soa[i].owner[j];
+    }
+  }
+  size_t *slot_of = (size_t*) malloc(sizeof(size_t) * queries);
+  long long *target_of = (long long*) malloc(sizeof(long long) * queries);
+  for (size_t k = 0; k < queries; ++k) {
+    slot_of[k] = (size_t) rand() % n;
+    target_of[k] = 1 + rand() % PS_MAX_CAPACITY;
+  }
+
+  size_t checksum_aos = 0, checksum_soa = 0;
+  double start = seconds();
+  for (size_t k = 0; k < queries; ++k) {
+    checksum_aos += aos_upper_bound(&aos[slot_of[k]], target_of[k]);
+  }
+  const double aos_time = seconds() - start;
+  start = seconds();
+  for (size_t k = 0; k < queries; ++k) {
+    checksum_soa += ps_upper_bound(&soa[slot_of[k]], target_of[k]);
+  }
+  const double soa_time = seconds() - start;
+
+  if (checksum_aos != checksum_soa) {
+    fprintf(stderr, "layouts disagree: %zu != %zu\n", checksum_aos, checksum_soa);
+    return 1;
+  }
+  printf("slots %zu, queries %zu\n", n, queries);
+  printf("AoS r_cmp scan   %8.2f ns/query\n", aos_time * 1e9 / queries);
+  printf("SoA lane search  %8.2f ns/query\n", soa_time * 1e9 / queries);
+  free(slot_of);
+  free(target_of);
+  free(aos);
+  free(soa);
+  return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Microbenchmark: the generic cds_heap (ch_push/ch_pop through the si_cmp callback) against heaps
+ * generated by TYPED_HEAP_DEFINE on the same Shuiyuan traffic as bench/shuiyuan_queue: CLEAR
+ * bursts pushed at time t, FETCH at t + 1 popping everything due. The typed heaps are run binary
+ * and 4-ary with one push per bicycle, and 4-ary with one push_batch per burst.
+ *
+ * Build: make bench
+ * Usage: bench/typed_heap [rounds] [burst] [step]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../cds.h"
+#include "../radix_heap.h"
+#include "typed_heap.h"
+
+static int si_cmp(const void *a, const void *b) {
+  const struct sy_info *ca = (const struct sy_info*) a;
+  const struct sy_info *cb = (const struct sy_info*) b;
+  if (ca->t != cb->t) {
+    return ca->t < cb->t ? -1 : 1;
+  }
+  return ca->owner < cb->owner ? -1 : ca->owner > cb->owner;
+}
+
+#define SI_LESS(a, b) ((a)->t < (b)->t || ((a)->t == (b)->t && (a)->owner < (b)->owner))
+
+TYPED_HEAP_DEFINE(si_heap2, struct sy_info, SI_LESS, 2)
+TYPED_HEAP_DEFINE(si_heap4, struct sy_info, SI_LESS, 4)
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t rounds = argc > 1 ? strtoull(argv[1], NULL, 10) : 20000;
+  const size_t burst = argc > 2 ? strtoull(argv[2], NULL, 10) : 300;
+  const long long step = argc > 3 ? strtoll(argv[3], NULL, 10) : 500;
+  long long *delay = (long long*) malloc(sizeof(long long) * burst);
+  long long *when = (long long*) malloc(sizeof(long long) * rounds);
+  struct sy_info *batch = (struct sy_info*) malloc(sizeof(struct sy_info) * burst);
+  srand(7);
+  for (size_t i = 0; i < burst; ++i) {
+    delay[i] = rand() % 1000001;
+  }
+  for (size_t r = 0; r < rounds; ++r) {
+    when[r] = (r > 0 ? when[r - 1] + 2 : 0) + rand() % (2 * step);
+  }
+
+  // Sum of fetched owners, so a heap that pops the right count in the wrong order still disagrees
+  unsigned long long check_generic = 0, check_binary = 0, check_quad = 0, check_batch = 0;
+  double start = seconds();
+  struct cds_heap heap = ch_new(sizeof(struct sy_info), si_cmp);
+  for (size_t r = 0; r < rounds; ++r) {
+    const long long t = when[r];
+    for (size_t i = 0; i < burst; ++i) {
+      struct sy_info info = { .owner = (int) i, .t = t + delay[(i + r) % burst] };
+      ch_push(&heap, &info);
+    }
+    while (ch_size(&heap) > 0 && ((struct sy_info*) ch_top(&heap))->t <= t + 1) {
+      check_generic = check_generic * 31 + (unsigned) ((struct sy_info*) ch_top(&heap))->owner;
+      ch_pop(&heap);
+    }
+  }
+  ch_delete(&heap);
+  const double generic_time = seconds() - start;
+
+  start = seconds();
+  struct si_heap2 binary = si_heap2_new();
+  for (size_t r = 0; r < rounds; ++r) {
+    const long long t = when[r];
+    for (size_t i = 0; i < burst; ++i) {
+      struct sy_info info = { .owner = (int) i, .t = t + delay[(i + r) % burst] };
+      si_heap2_push(&binary, info);
+    }
+    while (si_heap2_size(&binary) > 0 && si_heap2_top(&binary)->t <= t + 1) {
+      check_binary = check_binary * 31 + (unsigned) si_heap2_top(&binary)->owner;
+      si_heap2_pop(&binary);
+    }
+  }
+  si_heap2_delete(&binary);
+  const double binary_time = seconds() - start;
+
+  start = seconds();
+  struct si_heap4 quad = si_heap4_new();
+  for (size_t r = 0; r < rounds; ++r) {
+    const long long t = when[r];
+    for (size_t i = 0; i < burst; ++i) {
+      struct sy_info info = { .owner = (int) i, .t = t + delay[(i + r) % burst] };
+      si_heap4_push(&quad, info);
+    }
+    while (si_heap4_size(&quad) > 0 && si_heap4_top(&quad)->t <= t + 1) {
+      check_quad = check_quad * 31 + (unsigned) si_heap4_top(&quad)->owner;
+      si_heap4_pop(&quad);
+    }
+  }
+  si_heap4_delete(&quad);
+  const double quad_time = seconds() - start;
+
+  start = seconds();
+  struct si_heap4 batched = si_heap4_new();
+  for (size_t r = 0; r < rounds; ++r) {
+    const long long t = when[r];
+    for (size_t i = 0; i < burst; ++i) {
+      batch[i].owner = (int) i;
+      batch[i].t = t + delay[(i + r) % burst];
+    }
+    si_heap4_push_batch(&batched, batch, burst);
+    while (si_heap4_size(&batched) > 0 && si_heap4_top(&batched)->t <= t + 1) {
+      check_batch = check_batch * 31 + (unsigned) si_heap4_top(&batched)->owner;
+      si_heap4_pop(&batched);
+    }
+  }
+  si_heap4_delete(&batched);
+  const double batch_time = seconds() - start;
+
+  if (check_generic != check_binary || check_generic != check_quad ||
+      check_generic != check_batch) {
+    fprintf(stderr, "heaps disagree on the fetch order\n");
+    return 1;
+  }
+  printf("%zu rounds of %zu bicycles\n", rounds, burst);
+  printf("cds_heap          : %.3f s\n", generic_time);
+  printf("typed, binary     : %.3f s (%.2fx)\n", binary_time, generic_time / binary_time);
+  printf("typed, 4-ary      : %.3f s (%.2fx)\n", quad_time, generic_time / quad_time);
+  printf("typed, 4-ary batch: %.3f s (%.2fx)\n", batch_time, generic_time / batch_time);
+  free(delay);
+  free(when);
+  free(batch);
+  return 0;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * A bench-only alternative to cds_heap, instantiated by bench/typed_heap.c. The engine keeps
+ * Shuiyuan in the radix heap (radix_heap.h) and uses no comparison heap at all.
+ */
+
+/*
+ *********************************************************************************************************
+ *
+ *                                      TYPED HEAP DEFINE
+ *
+ * Description: Generates a min-heap specialized for one element type and ordering.
+ *
+ * Arguments: name   Prefix of the generated struct and functions.
+ *            type   The element type, stored by value.
+ *            less   A function or macro taking two const type * and returning nonzero if the first
+ *                   element must come out before the second.
+ *            arity  Children per node, a constant; 4 suits small elements, 2 gives a binary heap.
+ *
+ * Returns: Defines struct name and static inline functions
+ *            name_new, name_delete, name_size, name_top, name_push, name_push_batch, name_pop.
+ *
+ * Notes: Unlike cds_heap there is no element_size, no comparator pointer and no memcpy: elements
+ *        are assigned directly and less is inlined. The children of i are arity * i + 1 up to
+ *        arity * i + arity; with arity 4 the heap is half as deep as a binary one and the children
+ *        of a node share one or two cache lines. name_push_batch appends a whole batch and, when
+ *        the batch is large relative to the heap, rebuilds it bottom-up in O(n) instead of sifting
+ *        each element up.
+ *********************************************************************************************************
+ */
+#define TYPED_HEAP_DEFINE(name, type, less, arity)                                                   \
+  struct name {                                                                                      \
+    type *data;                                                                                      \
+    size_t size, capacity;                                                                           \
+  };                                                                                                 \
+                                                                                                     \
+  static inline struct name name##_new(void) {                                                       \
+    struct name h = { NULL, 0, 0 };                                                                  \
+    return h;                                                                                        \
+  }                                                                                                  \
+                                                                                                     \
+  static inline void name##_delete(struct name *h) {                                                 \
+    free(h->data);                                                                                   \
+    h->data = NULL;                                                                                  \
+    h->size = h->capacity = 0;                                                                       \
+  }                                                                                                  \
+                                                                                                     \
+  static inline size_t name##_size(const struct name *h) {                                           \
+    return h->size;                                                                                  \
+  }                                                                                                  \
+                                                                                                     \
+  static inline const type *name##_top(const struct name *h) {                                       \
+    return h->size > 0 ? &h->data[0] : NULL;                                                         \
+  }                                                                                                  \
+                                                                                                     \
+  static inline void name##_reserve(struct name *h, size_t capacity) {                               \
+    if (capacity <= h->capacity) {                                                                   \
+      return;                                                                                        \
+    }                                                                                                \
+    size_t grown = h->capacity ? h->capacity : 16;                                                   \
+    while (grown < capacity) {                                                                       \
+      grown *= 2;                                                                                    \
+    }                                                                                                \
+    h->data = (type*) realloc(h->data, sizeof(type) * grown);                                        \
+    if (h->data == NULL) {                                                                           \
+      fprintf(stderr, #name ": out of memory for %zu elements\n", grown);                            \
+      exit(-1);                                                                                      \
+    }                                                                                                \
+    h->capacity = grown;                                                                             \
+  }                                                                                                  \
+                                                                                                     \
+  static inline void name##_sift_up(struct name *h, size_t i) {                                      \
+    const type value = h->data[i];                                                                   \
+    while (i > 0) {                                                                                  \
+      const size_t parent = (i - 1) / arity;                                                         \
+      if (!less(&value, &h->data[parent])) {                                                         \
+        break;                                                                                       \
+      }                                                                                              \
+      h->data[i] = h->data[parent];                                                                  \
+      i = parent;                                                                                    \
+    }                                                                                                \
+    h->data[i] = value;                                                                              \
+  }                                                                                                  \
+                                                                                                     \
+  static inline void name##_sift_down(struct name *h, size_t i) {                                    \
+    const type value = h->data[i];                                                                   \
+    while (true) {                                                                                   \
+      const size_t first = arity * i + 1;                                                            \
+      if (first >= h->size) {                                                                        \
+        break;                                                                                       \
+      }                                                                                              \
+      const size_t last = first + arity < h->size ? first + arity : h->size;                         \
+      size_t best = first;                                                                           \
+      for (size_t c = first + 1; c < last; ++c) {                                                    \
+        if (less(&h->data[c], &h->data[best])) {                                                     \
+          best = c;                                                                                  \
+        }                                                                                            \
+      }                                                                                              \
+      if (!less(&h->data[best], &value)) {                                                           \
+        break;                                                                                       \
+      }                                                                                              \
+      h->data[i] = h->data[best];                                                                    \
+      i = best;                                                                                      \
+    }                                                                                                \
+    h->data[i] = value;                                                                              \
+  }                                                                                                  \
+                                                                                                     \
+  static inline void name##_push(struct name *h, type value) {                                       \
+    name##_reserve(h, h->size + 1);                                                                  \
+    h->data[h->size] = value;                                                                        \
+    name##_sift_up(h, h->size++);                                                                    \
+  }                                                                                                  \
+                                                                                                     \
+  static inline void name##_push_batch(struct name *h, const type *values, size_t count) {           \
+    name##_reserve(h, h->size + count);                                                              \
+    const size_t old_size = h->size;                                                                 \
+    for (size_t k = 0; k < count; ++k) {                                                             \
+      h->data[h->size++] = values[k];                                                                \
+    }                                                                                                \
+    if (count <= old_size / 8) {                                                                     \
+      for (size_t k = old_size; k < h->size; ++k) {                                                  \
+        name##_sift_up(h, k);                                                                        \
+      }                                                                                              \
+      return;                                                                                        \
+    }                                                                                                \
+    for (size_t k = h->size / arity + 1; k-- > 0;) {                                                 \
+      if (k < h->size) {                                                                             \
+        name##_sift_down(h, k);                                                                      \
+      }                                                                                              \
+    }                                                                                                \
+  }                                                                                                  \
+                                                                                                     \
+  static inline void name##_pop(struct name *h) {                                                    \
+    if (h->size == 0) {                                                                              \
+      return;                                                                                        \
+    }                                                                                                \
+    h->data[0] = h->data[--h->size];                                                                 \
+    if (h->size > 0) {                                                                               \
+      name##_sift_down(h, 0);                                                                        \
+    }                                                                                                \
+  }
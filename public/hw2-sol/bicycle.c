@@ -0,0 +1,225 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "rational.h"
+#include "dyadic.h"
+#include "large_slot.h"
+#include "bicycle.h"
+
+int b_cmp(const void *a, const void *b) {
+  struct bicycle *ba = (struct bicycle*) a;
+  struct bicycle *bb = (struct bicycle*) b;
+  int location_cmp_ret = r_cmp(&ba->location, &bb->location);
+  if (location_cmp_ret != 0) {
+    return location_cmp_ret;
+  }
+  if (ba->owner == bb->owner) {
+    fprintf(stderr, "there should not be two bicycles that owned by a person\n");
+    exit(-1);
+  }
+  return ba->owner < bb->owner ? -1 : 1;
+}
+
+struct ps ps_new(size_t capacity) {
+  struct ps new_ps = {
+    .size = PS_LANES,
+    .capacity = capacity,
+    .occupied = 0,
+    .large = NULL};
+  ps_truncate(&new_ps, 0);
+  if (capacity > PS_MAX_CAPACITY) {
+    new_ps.large = (struct large_slot*) malloc(sizeof(struct large_slot));
+    if (new_ps.large == NULL) {
+      fprintf(stderr, "out of memory for a slot of capacity %zu\n", capacity);
+      exit(-1);
+    }
+    *new_ps.large = ls_new(capacity);
+  }
+  return new_ps;
+}
+
+void ps_delete(struct ps *slot) {
+  ps_truncate(slot, 0);
+  slot->capacity = 0;
+  slot->occupied = 0;
+  if (slot->large != NULL) {
+    ls_delete(slot->large);
+    free(slot->large);
+    slot->large = NULL;
+  }
+}
+
+void ps_truncate(struct ps *slot, size_t size) {
+  for (size_t i = size; i < slot->size; ++i) {
+    slot->whole[i] = LLONG_MAX;
+    slot->frac[i] = 0;
+    slot->owner[i] = -1;
+  }
+  slot->size = size;
+}
+
+size_t ps_upper_bound(const struct ps *slot, long long position) {
+  size_t count = 0;
+#ifdef __AVX2__
+  const __m256i target = _mm256_set1_epi64x(position);
+  const __m256i zero = _mm256_setzero_si256();
+  for (size_t i = 0; i < slot->size; i += 4) {
+    const __m256i whole = _mm256_load_si256((const __m256i*) &slot->whole[i]);
+    const __m256i frac = _mm256_load_si256((const __m256i*) &slot->frac[i]);
+    const __m256i below = _mm256_cmpgt_epi64(target, whole);
+    const __m256i equal = _mm256_and_si256(_mm256_cmpeq_epi64(whole, target),
+      _mm256_cmpeq_epi64(frac, zero));
+    count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_or_si256(below, equal))));
+  }
+#else
+  for (size_t i = 0; i < slot->size; ++i) {
+    count += (slot->whole[i] < position) | ((slot->whole[i] == position) & (slot->frac[i] == 0));
+  }
+#endif
+  return count;
+}
+
+/*
+ * Points the records of the bicycles from index on at their current lanes.
+ */
+static void ps_refresh_ranks(const struct ps *slot, size_t index, struct ps_record *records) {
+  for (size_t i = index; i < slot->size; ++i) {
+    records[slot->owner[i]].rank = (int) i;
+  }
+}
+
+/*
+ * Inserts a bicycle at index, shifting the tail of every lane one place right.
+ */
+static void ps_insert_at(struct ps *slot, size_t index, struct dyadic location, int owner,
+    struct ps_record *records) {
+  if (slot->size == PS_MAX_BICYCLES) {
+    fprintf(stderr, "slot holds more than %d bicycles\n", PS_MAX_BICYCLES);
+    exit(-1);
+  }
+  const size_t tail = slot->size - index;
+  memmove(&slot->whole[index + 1], &slot->whole[index], sizeof(long long) * tail);
+  memmove(&slot->frac[index + 1], &slot->frac[index], sizeof(unsigned long long) * tail);
+  memmove(&slot->owner[index + 1], &slot->owner[index], sizeof(int) * tail);
+  slot->whole[index] = location.whole;
+  slot->frac[index] = location.frac;
+  slot->owner[index] = owner;
+  slot->size++;
+  ps_refresh_ranks(slot, index, records);
+}
+
+/*
+ * Returns the vacant integer position nearest to target (ties go to the smaller one),
+ * or 0 if every integer position of the slot is occupied.
+ */
+static size_t ps_nearest_vacancy(const struct ps *slot, size_t target) {
+  // Bits 1..capacity
+  const uint32_t all = ((uint32_t) 2 << slot->capacity) - 2;
+  const uint32_t vacant = all & ~slot->occupied;
+  if (vacant == 0) {
+    return 0;
+  }
+  const uint32_t bit = (uint32_t) 1 << target;
+  const uint32_t below = vacant & (bit - 1);
+  const uint32_t above = vacant & ~(bit | (bit - 1));
+  const size_t left = below ? (size_t) (31 - __builtin_clz(below)) : 0;
+  const size_t right = above ? (size_t) __builtin_ctz(above) : 0;
+  if (right == 0 || (left != 0 && target - left <= right - target)) {
+    return left;
+  }
+  return right;
+}
+
+struct dyadic ps_insert(struct ps *slot, int owner, size_t target_location, struct ps_record *records) {
+  if (slot->large != NULL) {
+    return ls_insert(slot->large, owner, target_location, records);
+  }
+  // Case 1 & 2: Target position is vacant, or park at the nearest vacant position
+  size_t position = target_location;
+  if (slot->occupied & ((uint32_t) 1 << target_location)) {
+    position = ps_nearest_vacancy(slot, target_location);
+  }
+  if (position != 0) {
+    struct dyadic location = d_from((long long) position);
+    ps_insert_at(slot, ps_upper_bound(slot, location.whole), location, owner, records);
+    slot->occupied |= (uint32_t) 1 << position;
+    return location;
+  }
+
+  // Case 3: No vacancies, insert at middle position
+  // The bicycle at the target is the last one not greater than it
+  size_t target_idx = ps_upper_bound(slot, (long long) target_location) - 1;
+  size_t neighbour_idx = target_idx > 0 ? target_idx - 1 : target_idx + 1;
+  if (neighbour_idx >= slot->size) {
+    fprintf(stderr, "Logic error: a full slot should hold more than one bicycle\n");
+    exit(EXIT_FAILURE);
+  }
+  struct dyadic neighbour = { .whole = slot->whole[neighbour_idx], .frac = slot->frac[neighbour_idx] };
+  struct dyadic location = d_mid(d_from((long long) target_location), neighbour);
+
+  // Left of the target it takes the target's index, right of it the neighbour's
+  ps_insert_at(slot, target_idx > 0 ? target_idx : neighbour_idx, location, owner, records);
+  return location;
+}
+
+int ps_erase(struct ps *slot, int target_id, struct ps_record *records) {
+  if (slot->large != NULL) {
+    return ls_erase(slot->large, target_id, records);
+  }
+  const size_t i = (size_t) records[target_id].rank;
+  if (i >= slot->size || slot->owner[i] != target_id) {
+    return -1;
+  }
+  if (slot->frac[i] == 0) {
+    slot->occupied &= ~((uint32_t) 1 << slot->whole[i]);
+  }
+  const size_t tail = slot->size - i - 1;
+  memmove(&slot->whole[i], &slot->whole[i + 1], sizeof(long long) * tail);
+  memmove(&slot->frac[i], &slot->frac[i + 1], sizeof(unsigned long long) * tail);
+  memmove(&slot->owner[i], &slot->owner[i + 1], sizeof(int) * tail);
+  ps_truncate(slot, slot->size - 1);
+  ps_refresh_ranks(slot, i, records);
+  return 0;
+}
+
+size_t ps_size(const struct ps *slot) {
+  return slot->large != NULL ? slot->large->size : slot->size;
+}
+
+size_t ps_clear(struct ps *slot, int *owners) {
+  if (slot->large != NULL) {
+    return ls_clear(slot->large, owners);
+  }
+  const size_t count = slot->size;
+  memcpy(owners, slot->owner, sizeof(int) * count);
+  ps_truncate(slot, 0);
+  slot->occupied = 0;
+  return count;
+}
+
+size_t ps_rearrange(struct ps *slot, int *owners, struct ps_record *records) {
+  if (slot->large != NULL) {
+    return ls_rearrange(slot->large, owners);
+  }
+  size_t count = 0, new_size = 0;
+  for (size_t i = 0; i < slot->size; ++i) {
+    if (slot->frac[i] != 0) {
+      owners[count++] = slot->owner[i];
+    } else {
+      if (new_size != i) {
+        slot->whole[new_size] = slot->whole[i];
+        slot->frac[new_size] = slot->frac[i];
+        slot->owner[new_size] = slot->owner[i];
+        records[slot->owner[i]].rank = (int) new_size;
+      }
+      new_size++;
+    }
+  }
+  ps_truncate(slot, new_size);
+  return count;
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rational.h"
+#include "dyadic.h"
+#include "large_slot.h"
+
+struct bicycle {
+  struct rational location;
+  int owner;
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                          BICYCLE CMP
+ * 
+ * Description: Compares two bicycles based on their locations and owners.
+ * 
+ * Arguments: a, b   Pointers to the bicycles to compare.
+ *
+ * Returns: Negative if a is before b, 0 if equal, positive if a is after b.
+ * 
+ * Notes: Primary key is location, secondary key is owner. Errors if owners are the same.
+ *********************************************************************************************************
+ */
+int b_cmp(const void *a, const void *b);
+
+#define PS_MAX_CAPACITY 15
+#define PS_MAX_BICYCLES (2 * PS_MAX_CAPACITY)
+#define PS_LANES 32  // PS_MAX_BICYCLES rounded up to whole 256-bit vectors
+#define PS_ALIGNMENT 64
+
+/*
+ * The bicycles of a slot are kept sorted by location as a structure of arrays: the i-th bicycle is
+ * at the dyadic position whole[i] + frac[i] / 2^64 and belongs to owner[i]. Lanes from size on hold
+ * the sentinel LLONG_MAX + 0, which is greater than every real location, so searches may run over
+ * whole vectors without a tail loop. With the fields after them a slot takes 704 bytes, eleven cache
+ * lines, whatever its capacity.
+ *
+ * A slot with more than PS_MAX_CAPACITY positions keeps its bicycles in a struct large_slot instead;
+ * its lanes stay empty and the ps_* functions forward to the ls_* ones.
+ */
+struct ps {
+  _Alignas(PS_ALIGNMENT) long long whole[PS_LANES];
+  unsigned long long frac[PS_LANES];
+  int owner[PS_LANES];
+  size_t size;
+  size_t capacity;
+  uint32_t occupied;  // bit i is set iff integer position i holds a bicycle
+  struct large_slot *large;  // NULL unless capacity > PS_MAX_CAPACITY
+};
+
+/*
+ * Where a student's bicycle was last parked. The slot engine keeps rank equal to the bicycle's index
+ * in its slot's lanes across inserts and erases, so a bicycle can be removed without a search. In a
+ * large slot rank is the index of the bicycle's node, which does not move.
+ */
+struct ps_record {
+  size_t slot;
+  int rank;
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                      PARKING SLOT NEW
+ * 
+ * Description: Creates a new parking slot with the specified capacity.
+ * 
+ * Arguments: capacity   The maximum number of bicycles that can be parked at integer positions.
+ *
+ * Returns: A newly created struct ps instance.
+ * 
+ * Notes: The bicycles arr is initialized as empty. Up to PS_MAX_CAPACITY the bicycles (at most twice
+ *        the capacity) are stored inline in the slot; larger capacities get a struct large_slot.
+ *        The caller is responsible for freeing it using ps_delete.
+ *********************************************************************************************************
+ */
+struct ps ps_new(size_t capacity);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    PARKING SLOT DELETE
+ * 
+ * Description: Empties a parking slot.
+ * 
+ * Arguments: slot   Pointer to the parking slot to delete.
+ *
+ * Returns: void
+ * 
+ * Notes: Sets the capacity to 0. Only the struct large_slot of a large slot is freed.
+ *********************************************************************************************************
+ */
+void ps_delete(struct ps *slot);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    PARKING SLOT UPPER BOUND
+ * 
+ * Description: Finds where a bicycle at an integer position goes in the sorted lanes.
+ * 
+ * Arguments: slot       Pointer to the parking slot.
+ *            position   The integer position to search for.
+ *
+ * Returns: The index of the first bicycle whose location is greater than position.
+ * 
+ * Notes: Counts the lanes not greater than position, which equals the index because the lanes are
+ *        sorted. Uses AVX2 compares on four 64-bit lanes at a time when built with -mavx2.
+ *********************************************************************************************************
+ */
+size_t ps_upper_bound(const struct ps *slot, long long position);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    PARKING SLOT INSERT
+ * 
+ * Description: Inserts a bicycle into a parking slot based on the parking policy.
+ * 
+ * Arguments: slot             Pointer to the parking slot.
+ *            owner            ID of the bicycle owner.
+ *            target_location  The intended parking position.
+ *            records          Per-owner records; the ranks of the new bicycle and of every bicycle
+ *                             shifted by the insertion are refreshed.
+ *
+ * Returns: The final position of the bicycle as a dyadic number.
+ * 
+ * Notes: Follows the parking policy described in the problem statement:
+ *        1. If target_location is vacant, park there.
+ *        2. If there's another vacancy in the slot, park at the nearest one.
+ *        3. Otherwise, park at the middle position between appropriate bicycles.
+ *        Vacancies are found from the occupancy mask, so no allocation or scan over positions is needed.
+ *        Large slots find them from their run tree in O(log k) instead.
+ *********************************************************************************************************
+ */
+struct dyadic ps_insert(struct ps *slot, int owner, size_t target_location, struct ps_record *records);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    PARKING SLOT ERASE
+ * 
+ * Description: Removes a bicycle with the specified owner ID from a parking slot.
+ * 
+ * Arguments: slot       Pointer to the parking slot.
+ *            target_id  The ID of the bicycle owner to remove.
+ *            records    Per-owner records; the ranks of the bicycles shifted by the removal are refreshed.
+ *
+ * Returns: 0 on success, -1 if the bicycle is not found.
+ * 
+ * Notes: Finds the bicycle through records[target_id].rank instead of searching the slot.
+ *********************************************************************************************************
+ */
+int ps_erase(struct ps *slot, int target_id, struct ps_record *records);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    PARKING SLOT TRUNCATE
+ * 
+ * Description: Drops every bicycle from index size on.
+ * 
+ * Arguments: slot   Pointer to the parking slot.
+ *            size   The number of bicycles to keep.
+ *
+ * Returns: void
+ * 
+ * Notes: Restores the sentinel in the dropped lanes. The occupancy mask is not touched, so callers
+ *        removing integer-positioned bicycles have to update it themselves.
+ *********************************************************************************************************
+ */
+void ps_truncate(struct ps *slot, size_t size);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    PARKING SLOT SIZE
+ * 
+ * Description: Returns the number of bicycles in a parking slot.
+ * 
+ * Arguments: slot   Pointer to the parking slot.
+ *
+ * Returns: The number of bicycles, integer and fractional.
+ * 
+ * Notes: None.
+ *********************************************************************************************************
+ */
+size_t ps_size(const struct ps *slot);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    PARKING SLOT CLEAR
+ * 
+ * Description: Removes every bicycle from a parking slot.
+ * 
+ * Arguments: slot     Pointer to the parking slot.
+ *            owners   Receives the owners of the removed bicycles; needs room for ps_size(slot).
+ *
+ * Returns: The number of bicycles removed.
+ * 
+ * Notes: None.
+ *********************************************************************************************************
+ */
+size_t ps_clear(struct ps *slot, int *owners);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                  PARKING SLOT REARRANGE
+ * 
+ * Description: Removes every bicycle at a non-integer position from a parking slot.
+ * 
+ * Arguments: slot     Pointer to the parking slot.
+ *            owners   Receives the owners of the removed bicycles; needs room for ps_size(slot).
+ *            records  Per-owner records; the ranks of the bicycles that stay are refreshed.
+ *
+ * Returns: The number of bicycles removed.
+ * 
+ * Notes: Only fractional bicycles leave, so the occupied integer positions do not change.
+ *********************************************************************************************************
+ */
+size_t ps_rearrange(struct ps *slot, int *owners, struct ps_record *records);
@@ -0,0 +1,281 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "rational.h"
+#include "dyadic.h"
+#include "bicycle.h"
+#include "radix_heap.h"
+#include "ready_count.h"
+#include "bpt.h"
+
+struct bicycle_pt bpt_new(size_t n, size_t m) {
+  struct bicycle_pt new_pt = {
+    .n = n,
+    .m = m,
+    .pss = (struct ps*) aligned_alloc(PS_ALIGNMENT, sizeof(struct ps) * n),
+    .edge_start = (size_t*) calloc(n + 1, sizeof(size_t)),
+    .edges = (struct edge*) malloc(sizeof(struct edge) * 2 * (n - 1)),
+    .delay = (long long*) malloc(sizeof(long long) * m),
+    .order = (int*) calloc(n, sizeof(int)),
+    .parent = (int*) malloc(sizeof(int) * n),
+    .ssz = (int*) calloc(n, sizeof(int)),
+    .dep = (int*) malloc(sizeof(int) * n),
+    .dis_from_root = (long long*) calloc(n, sizeof(long long)),
+    .lca_table = NULL,
+    .rebuilt = false,
+    .binary_index_tree = (long long*) calloc(n + 1, sizeof(long long)),
+    .edge_weight = (long long*) calloc(n, sizeof(long long)),
+    .records = (struct ps_record*) calloc(m, sizeof(struct ps_record)),
+    .leaving = (int*) malloc(sizeof(int) * m),
+#ifdef SHUIYUAN_COUNT_ONLY
+    .sy = rc_new()};
+#else
+    .sy = rh_new()};
+#endif
+  return new_pt;
+}
+
+void bpt_delete(struct bicycle_pt *pt) {
+  for (int i = 0; i < pt->n; ++i) {
+    ps_delete(&pt->pss[i]);
+  }
+  free(pt->pss);
+  free(pt->edge_start);
+  free(pt->edges);
+  free(pt->delay);
+  free(pt->binary_index_tree);
+  free(pt->edge_weight);
+  free(pt->order);
+  free(pt->parent);
+  free(pt->dep);
+  free(pt->ssz);
+  free(pt->dis_from_root);
+  free(pt->lca_table);
+  free(pt->records);
+  free(pt->leaving);
+#ifdef SHUIYUAN_COUNT_ONLY
+  rc_delete(&pt->sy);
+#else
+  rh_delete(&pt->sy);
+#endif
+}
+
+void bit_range_add(struct bicycle_pt *pt, int left, int right, long long delta) {
+  for (int i = left; i <= pt->n; i += (i & -i)) {
+    pt->binary_index_tree[i] += delta;
+  }
+  for (int i = right + 1; i <= pt->n; i += (i & -i)) {
+    pt->binary_index_tree[i] -= delta;
+  }
+}
+
+long long bit_prefix_sum(struct bicycle_pt *pt, int index) {
+  long long ret = 0;
+  for (int i = index; i > 0; i -= (i & -i)) {
+    ret += pt->binary_index_tree[i];
+  }
+  return ret;
+}
+
+void bpt_build(struct bicycle_pt *pt, const struct tree_edge *list) {
+  bpt_build_adjacency(pt, list);
+  bpt_find_parent(pt);
+  bpt_build_order(pt);
+  bpt_build_lca(pt);
+}
+
+void bpt_build_adjacency(struct bicycle_pt *pt, const struct tree_edge *list) {
+  size_t *start = pt->edge_start;
+  for (size_t i = 0; i + 1 < pt->n; ++i) {
+    start[list[i].x + 1]++;
+    start[list[i].y + 1]++;
+  }
+  for (size_t v = 0; v < pt->n; ++v) {
+    start[v + 1] += start[v];
+  }
+  // start[v] walks forward as v's edges are filled, and ends at v + 1's offset
+  for (size_t i = 0; i + 1 < pt->n; ++i) {
+    pt->edges[start[list[i].x]++] = (struct edge) { .to = list[i].y, .dis = list[i].dis };
+    pt->edges[start[list[i].y]++] = (struct edge) { .to = list[i].x, .dis = list[i].dis };
+  }
+  for (size_t v = pt->n; v > 0; --v) {
+    start[v] = start[v - 1];
+  }
+  start[0] = 0;
+}
+
+void bpt_find_parent(struct bicycle_pt *pt) {
+  // Breadth-first order: every parent comes before its children
+  int *queue = (int*) malloc(sizeof(int) * pt->n);
+  size_t head = 0, tail = 0;
+  queue[tail++] = 0;
+  pt->parent[0] = 0;
+  pt->dep[0] = 0;
+  pt->dis_from_root[0] = 0;
+  while (head < tail) {
+    const int now = queue[head++];
+    for (size_t i = pt->edge_start[now]; i < pt->edge_start[now + 1]; ++i) {
+      const struct edge *next = &pt->edges[i];
+      if (next->to == pt->parent[now]) continue;
+      pt->parent[next->to] = now;
+      pt->dep[next->to] = pt->dep[now] + 1;
+      pt->dis_from_root[next->to] = pt->dis_from_root[now] + next->dis;
+      pt->edge_weight[next->to] = next->dis;
+      queue[tail++] = (int) next->to;
+    }
+  }
+  // Reverse order: every child is finished before its parent
+  for (size_t i = 0; i < tail; ++i) {
+    pt->ssz[queue[i]] = 1;
+  }
+  for (size_t i = tail - 1; i > 0; --i) {
+    pt->ssz[pt->parent[queue[i]]] += pt->ssz[queue[i]];
+  }
+  free(queue);
+}
+
+void bpt_build_order(struct bicycle_pt *pt) {
+  int *stack = (int*) malloc(sizeof(int) * pt->n);
+  size_t size = 0;
+  int stamp = 1;
+  stack[size++] = 0;
+  while (size > 0) {
+    const int now = stack[--size];
+    pt->order[now] = stamp++;
+    for (size_t i = pt->edge_start[now]; i < pt->edge_start[now + 1]; ++i) {
+      const struct edge *next = &pt->edges[i];
+      if (next->to == pt->parent[now]) continue;
+      stack[size++] = (int) next->to;
+    }
+  }
+  free(stack);
+}
+
+/*
+ * Returns whichever of a and b is closer to the root.
+ */
+static int bpt_shallower(const struct bicycle_pt *pt, int a, int b) {
+  return pt->dep[a] < pt->dep[b] ? a : b;
+}
+
+void bpt_build_lca(struct bicycle_pt *pt) {
+  const size_t n = pt->n;
+  int levels = 1;
+  while (((size_t) 1 << levels) <= n) {
+    levels++;
+  }
+  pt->lca_table = (int*) malloc(sizeof(int) * levels * n);
+  for (size_t v = 0; v < n; ++v) {
+    pt->lca_table[pt->order[v] - 1] = (int) v;
+  }
+  for (int k = 1; k < levels; ++k) {
+    const int *prev = pt->lca_table + (size_t) (k - 1) * n;
+    int *cur = pt->lca_table + (size_t) k * n;
+    const size_t half = (size_t) 1 << (k - 1);
+    for (size_t i = 0; i + 2 * half <= n; ++i) {
+      cur[i] = bpt_shallower(pt, prev[i], prev[i + half]);
+    }
+  }
+}
+
+int bpt_lca(struct bicycle_pt *pt, int u, int v) {
+  if (u == v) {
+    return u;
+  }
+  // Positions (order[u], order[v]] in the 0-based table are [order[u], order[v] - 1]
+  int left = pt->order[u], right = pt->order[v];
+  if (left > right) {
+    int tp = left;
+    left = right;
+    right = tp;
+  }
+  right--;
+  const int k = 31 - __builtin_clz(right - left + 1);
+  const int *level = pt->lca_table + (size_t) k * pt->n;
+  return pt->parent[bpt_shallower(pt, level[left], level[right - (1 << k) + 1])];
+}
+
+long long bpt_find_dis(struct bicycle_pt *pt, size_t from, size_t to) {
+  const int lca = bpt_lca(pt, (int) from, (int) to);
+  long long ret = pt->dis_from_root[from] + pt->dis_from_root[to] - 2 * pt->dis_from_root[lca];
+  if (pt->rebuilt) {
+    ret += bit_prefix_sum(pt, pt->order[from]) + bit_prefix_sum(pt, pt->order[to]) -
+        2 * bit_prefix_sum(pt, pt->order[lca]);
+  }
+  return ret;
+}
+
+
+struct park_result bpt_park(struct bicycle_pt *pt, int s, size_t x, size_t p) {
+  // The position is kept in dyadic form and only reduced to p/q here, for the result
+  struct park_result result = {
+    .s = s,
+    .x = x,
+    .position = d_to_rational(ps_insert(&pt->pss[x], s, p, pt->records))};
+  pt->records[s].slot = x;
+  return result;
+}
+
+struct move_result bpt_move(struct bicycle_pt *pt, int s, size_t y, size_t p) {
+  const size_t x = pt->records[s].slot;
+  struct move_result result = { .s = s, .y = y, .t = 0 };
+  if (x != y) {
+    ps_erase(&pt->pss[x], s, pt->records);
+    result.t = bpt_find_dis(pt, x, y);
+    ps_insert(&pt->pss[y], s, p, pt->records);
+    pt->records[s].slot = y;
+  }
+  return result;
+}
+
+void bpt_send_to_shuiyuan(struct bicycle_pt *pt, int s, long long t) {
+  const long long ready = t + pt->delay[s];
+#ifdef SHUIYUAN_COUNT_ONLY
+  rc_push(&pt->sy, t, ready);
+#else
+  struct sy_info info = { .owner = s, .t = ready };
+  rh_push(&pt->sy, info);
+#endif
+}
+
+struct clear_result bpt_clear(struct bicycle_pt *pt, size_t x, long long t) {
+  struct clear_result result = { .x = x, .count = ps_clear(&pt->pss[x], pt->leaving) };
+  for (size_t i = 0; i < result.count; ++i) {
+    bpt_send_to_shuiyuan(pt, pt->leaving[i], t);
+  }
+  return result;
+}
+
+struct rearrange_result bpt_rearrange(struct bicycle_pt *pt, size_t x, long long t) {
+  struct rearrange_result result = {
+    .x = x,
+    .count = ps_rearrange(&pt->pss[x], pt->leaving, pt->records)};
+  for (size_t i = 0; i < result.count; ++i) {
+    bpt_send_to_shuiyuan(pt, pt->leaving[i], t);
+  }
+  return result;
+}
+
+struct fetch_result bpt_fetch(struct bicycle_pt *pt, long long t) {
+#ifdef SHUIYUAN_COUNT_ONLY
+  struct fetch_result result = { .t = t, .count = rc_drain(&pt->sy, t) };
+#else
+  struct fetch_result result = { .t = t, .count = rh_drain(&pt->sy, t) };
+#endif
+  return result;
+}
+
+struct rebuild_result bpt_rebuild(struct bicycle_pt *pt, size_t x, size_t y, long long d) {
+  if (pt->dep[x] > pt->dep[y]) {
+    size_t tp = x;
+    x = y;
+    y = tp;
+  }
+  // Every distance from the root into the subtree of y changes by the same amount
+  struct rebuild_result result = { .previous = pt->edge_weight[y] };
+  bit_range_add(pt, pt->order[y], pt->order[y] + pt->ssz[y] - 1, d - pt->edge_weight[y]);
+  pt->edge_weight[y] = d;
+  pt->rebuilt = true;
+  return result;
+}
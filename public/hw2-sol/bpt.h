@@ -0,0 +1,424 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "rational.h"
+#include "bicycle.h"
+#include "radix_heap.h"
+#include "ready_count.h"
+
+/*
+ * The bicycle parking tree engine. Operations return result structs and do no I/O, so the engine
+ * can be linked into other programs; answer.c is the command-line front end and report.h formats
+ * results for it.
+ *
+ * Build options: by default Shuiyuan is a radix heap of (owner, ready time) pairs. Compiling with
+ * -DSHUIYUAN_COUNT_ONLY keeps only a count of ready times (ready_count.h), so FETCH costs
+ * O(log 10^6) however many bicycles it returns. It measures no faster than the radix heap
+ * (bench/shuiyuan_queue) and stores no owners, so it is not the default.
+ */
+
+enum Operation {
+  PARK = 0,
+  MOVE = 1,
+  CLEAR = 2,
+  REARRANGE = 3,
+  FETCH = 4,
+  REBUILD = 5
+};
+
+struct edge {
+  size_t to;
+  long long dis;
+};
+
+struct tree_edge {
+  size_t x, y;
+  long long dis;
+};
+
+struct park_result {
+  int s;
+  size_t x;
+  struct rational position;  // reduced, q == 1 for integer positions
+};
+
+struct move_result {
+  int s;
+  size_t y;
+  long long t;  // travel time, 0 when the bicycle stays in its slot
+};
+
+struct clear_result {
+  size_t x;
+  size_t count;  // bicycles sent to Shuiyuan
+};
+
+struct rearrange_result {
+  size_t x;
+  size_t count;  // bicycles sent to Shuiyuan
+};
+
+struct fetch_result {
+  long long t;
+  size_t count;  // bicycles fetched back from Shuiyuan
+};
+
+struct rebuild_result {
+  long long previous;  // weight of the edge before the change
+};
+
+struct bicycle_pt {
+  size_t n, m;
+  struct ps *pss;
+  size_t *edge_start;  // CSR adjacency: the edges of v are edges[edge_start[v], edge_start[v + 1])
+  struct edge *edges;
+  long long *delay;
+  int *order;
+  int *parent;
+  int *ssz;
+  int *dep;
+  long long *dis_from_root;
+  int *lca_table;  // sparse table over DFS order, level k at [k * n, (k + 1) * n)
+  bool rebuilt;    // some edge has changed, so dis_from_root needs the BIT's correction
+  long long *binary_index_tree;  // differences of the change to dis_from_root, by DFS order
+  long long *edge_weight;        // current weight of the edge from each node to its parent
+  struct ps_record *records;
+  int *leaving;             // owners leaving a slot in CLEAR or REARRANGE, room for m
+#ifdef SHUIYUAN_COUNT_ONLY
+  struct ready_count sy;    // Shuiyuan, as a count of ready times
+#else
+  struct radix_heap sy;     // Shuiyuan, keyed on the time each bicycle becomes fetchable
+#endif
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                               BINARY INDEX TREE RANGE ADD
+ * 
+ * Description: Adds a value to every position of a range in the Binary Indexed Tree.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            left           The start index of the range (inclusive).
+ *            right          The end index of the range (inclusive).
+ *            delta          The value to add.
+ *
+ * Returns: void
+ * 
+ * Notes: The tree stores differences, so the range costs two point updates.
+ *********************************************************************************************************
+ */
+void bit_range_add(struct bicycle_pt *pt, int left, int right, long long delta);
+
+/*
+ *********************************************************************************************************
+ *
+ *                               BINARY INDEX TREE PREFIX SUM
+ * 
+ * Description: Calculates the prefix sum up to the given index in the Binary Indexed Tree.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            index          The index up to which to calculate the prefix sum.
+ *
+ * Returns: The prefix sum up to the given index.
+ * 
+ * Notes: Since the tree stores differences, this is the total added at position index.
+ *********************************************************************************************************
+ */
+long long bit_prefix_sum(struct bicycle_pt *pt, int index);
+
+/*
+ *********************************************************************************************************
+ *
+ *                              BICYCLE PARKING TREE NEW
+ * 
+ * Description: Creates a new bicycle parking tree with the specified number of nodes and students.
+ * 
+ * Arguments: n   The number of parking slots (nodes).
+ *            m   The number of students (users).
+ *
+ * Returns: A newly created struct bicycle_pt instance.
+ * 
+ * Notes: Allocates memory for all necessary data structures. The slots dominate: every one holds
+ *        its lanes inline, sizeof(struct ps) = 704 bytes, so n = 3 * 10^5 slots take about 211 MB
+ *        before any bicycle is parked.
+ *********************************************************************************************************
+ */
+struct bicycle_pt bpt_new(size_t n, size_t m);
+
+/*
+ *********************************************************************************************************
+ *
+ *                             BICYCLE PARKING TREE DELETE
+ * 
+ * Description: Frees the memory allocated for a bicycle parking tree.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree to delete.
+ *
+ * Returns: void
+ * 
+ * Notes: Recursively frees all allocated memory.
+ *********************************************************************************************************
+ */
+void bpt_delete(struct bicycle_pt *pt);
+
+/*
+ *********************************************************************************************************
+ *
+ *                              BICYCLE PARKING TREE BUILD
+ * 
+ * Description: Prepares the tree for operations.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree, with every slot already created.
+ *            list           The n - 1 undirected edges of the tree.
+ *
+ * Returns: void
+ * 
+ * Notes: Runs bpt_build_adjacency, bpt_find_parent, bpt_build_order and bpt_build_lca in order.
+ *        The list is not kept and may be freed afterwards.
+ *********************************************************************************************************
+ */
+void bpt_build(struct bicycle_pt *pt, const struct tree_edge *list);
+
+/*
+ *********************************************************************************************************
+ *
+ *                          BICYCLE PARKING TREE BUILD ADJACENCY
+ * 
+ * Description: Builds the compressed sparse row adjacency of the tree from its edge list.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            list           The n - 1 undirected edges of the tree.
+ *
+ * Returns: void
+ * 
+ * Notes: Counts degrees, turns them into offsets with a prefix sum, then fills both directions of
+ *        every edge. Each node keeps its edges in input order.
+ *********************************************************************************************************
+ */
+void bpt_build_adjacency(struct bicycle_pt *pt, const struct tree_edge *list);
+
+/*
+ *********************************************************************************************************
+ *
+ *                          BICYCLE PARKING TREE FIND PARENT
+ * 
+ * Description: Builds the parent-child relationships in the tree and calculates subtree sizes.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree, rooted at node 0.
+ *
+ * Returns: void
+ * 
+ * Notes: Also sets depth, distance from the root and the weight of the edge to the parent for each
+ *        node. Runs iteratively: a breadth-first pass for parents, then the same order in reverse
+ *        for subtree sizes, so path-shaped trees need no deep stack.
+ *********************************************************************************************************
+ */
+void bpt_find_parent(struct bicycle_pt *pt);
+
+/*
+ *********************************************************************************************************
+ *
+ *                          BICYCLE PARKING TREE BUILD ORDER
+ * 
+ * Description: Assigns the DFS order that the LCA table and the Binary Indexed Tree are indexed by.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *
+ * Returns: void
+ * 
+ * Notes: The subtree of x occupies positions order[x] ... order[x] + ssz[x] - 1. Any preorder
+ *        will do, so children are visited in whatever order an explicit stack gives. Requires
+ *        bpt_find_parent.
+ *********************************************************************************************************
+ */
+void bpt_build_order(struct bicycle_pt *pt);
+
+/*
+ *********************************************************************************************************
+ *
+ *                           BICYCLE PARKING TREE BUILD LCA
+ * 
+ * Description: Builds the sparse table for constant-time lowest common ancestor queries.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *
+ * Returns: void
+ * 
+ * Notes: Level k holds, for each DFS order position i, the shallowest node among positions
+ *        [i, i + 2^k). All levels share one allocation. Requires order, parent and dep.
+ *********************************************************************************************************
+ */
+void bpt_build_lca(struct bicycle_pt *pt);
+
+/*
+ *********************************************************************************************************
+ *
+ *                              BICYCLE PARKING TREE LCA
+ * 
+ * Description: Finds the lowest common ancestor of two nodes.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            u, v           The two nodes.
+ *
+ * Returns: The lowest common ancestor of u and v.
+ * 
+ * Notes: For u != v with order[u] < order[v], the shallowest node at DFS positions (order[u],
+ *        order[v]] is a child of the LCA, so one sparse table lookup answers the query in O(1).
+ *********************************************************************************************************
+ */
+int bpt_lca(struct bicycle_pt *pt, int u, int v);
+
+/*
+ *********************************************************************************************************
+ *
+ *                          BICYCLE PARKING TREE FIND DIS
+ * 
+ * Description: Calculates the distance (travel time) between two nodes in the tree.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            from           The source node.
+ *            to             The destination node.
+ *
+ * Returns: The distance (travel time) from the source to the destination.
+ * 
+ * Notes: dis_from_root[from] + dis_from_root[to] - 2 * dis_from_root[lca] with an O(1) LCA. After a
+ *        REBUILD each of the three depths also takes its correction from the Binary Indexed Tree,
+ *        three prefix sums in O(log n).
+ *********************************************************************************************************
+ */
+long long bpt_find_dis(struct bicycle_pt *pt, size_t from, size_t to);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                BICYCLE PARKING TREE PARK
+ * 
+ * Description: Handles a PARK operation - parking a bicycle at a specific slot.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            s              The student ID.
+ *            x              The parking slot.
+ *            p              The intended parking position.
+ *
+ * Returns: The student, the slot and the final parking position.
+ * 
+ * Notes: Updates the record of the student.
+ *********************************************************************************************************
+ */
+struct park_result bpt_park(struct bicycle_pt *pt, int s, size_t x, size_t p);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                BICYCLE PARKING TREE MOVE
+ * 
+ * Description: Handles a MOVE operation - moving a bicycle from one slot to another.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            s              The student ID.
+ *            y              The destination parking slot.
+ *            p              The intended parking position at the destination.
+ *
+ * Returns: The student, the destination slot and the travel time.
+ * 
+ * Notes: Updates the record of the student. Moving to the current slot leaves the bicycle where it
+ *        is and takes 0 seconds.
+ *********************************************************************************************************
+ */
+struct move_result bpt_move(struct bicycle_pt *pt, int s, size_t y, size_t p);
+
+/*
+ *********************************************************************************************************
+ *
+ *                           BICYCLE PARKING TREE SEND TO SHUIYUAN
+ * 
+ * Description: Sends the bicycle of a student to Shuiyuan.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            s              The student whose bicycle leaves its slot.
+ *            t              The current time.
+ *
+ * Returns: void
+ * 
+ * Notes: The bicycle becomes fetchable at t + delay[s]. Does not touch any slot; bpt_clear and
+ *        bpt_rearrange call it for the bicycles they remove.
+ *********************************************************************************************************
+ */
+void bpt_send_to_shuiyuan(struct bicycle_pt *pt, int s, long long t);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                BICYCLE PARKING TREE CLEAR
+ * 
+ * Description: Handles a CLEAR operation - clearing all bicycles from a parking slot.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            x              The parking slot to clear.
+ *            t              The current time.
+ *
+ * Returns: The slot and the number of bicycles cleared.
+ * 
+ * Notes: Adds all cleared bicycles to the sy h with appropriate fetch times.
+ *********************************************************************************************************
+ */
+struct clear_result bpt_clear(struct bicycle_pt *pt, size_t x, long long t);
+
+/*
+ *********************************************************************************************************
+ *
+ *                              BICYCLE PARKING TREE REARRANGE
+ * 
+ * Description: Handles a REARRANGE operation - removing non-integer positioned bicycles.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            x              The parking slot to rearrange.
+ *            t              The current time.
+ *
+ * Returns: The slot and the number of bicycles removed.
+ * 
+ * Notes: Adds removed bicycles to the sy h.
+ *********************************************************************************************************
+ */
+struct rearrange_result bpt_rearrange(struct bicycle_pt *pt, size_t x, long long t);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                BICYCLE PARKING TREE FETCH
+ * 
+ * Description: Handles a FETCH operation - retrieving bicycles from sy.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            t              The current time.
+ *
+ * Returns: The time and the number of bicycles fetched.
+ * 
+ * Notes: Removes bicycles from the sy h if their fetch time is <= t, draining whole radix heap
+ *        buckets instead of popping them one by one.
+ *********************************************************************************************************
+ */
+struct fetch_result bpt_fetch(struct bicycle_pt *pt, long long t);
+
+/*
+ *********************************************************************************************************
+ *
+ *                               BICYCLE PARKING TREE REBUILD
+ * 
+ * Description: Handles a REBUILD operation - changing the weight of an edge in the tree.
+ * 
+ * Arguments: pt   Pointer to the bicycle parking tree.
+ *            x, y           The endpoints of the edge to modify.
+ *            d              The new weight for the edge.
+ *
+ * Returns: The previous weight of the edge.
+ * 
+ * Notes: Adds the change of weight to every position of the subtree of the deeper endpoint.
+ *********************************************************************************************************
+ */
+struct rebuild_result bpt_rebuild(struct bicycle_pt *pt, size_t x, size_t y, long long d);
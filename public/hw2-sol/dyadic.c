@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rational.h"
+#include "dyadic.h"
+
+struct dyadic d_from(long long whole) {
+  struct dyadic new_dyadic = {whole, 0};
+  return new_dyadic;
+}
+
+struct dyadic d_mid(struct dyadic a, struct dyadic b) {
+  const __int128 one = (__int128) 1 << D_FRACTION_BITS;
+  const __int128 sum = (a.whole * one + a.frac) + (b.whole * one + b.frac);
+  if (sum & 1) {
+    fprintf(stderr, "midpoint needs more than %d fractional bits\n", D_FRACTION_BITS);
+    exit(-1);
+  }
+  const __int128 mid = sum / 2;
+  struct dyadic ret = {
+    .whole = (long long) (mid >> D_FRACTION_BITS),
+    .frac = (unsigned long long) mid};
+  return ret;
+}
+
+int d_cmp(const struct dyadic *a, const struct dyadic *b) {
+  if (a->whole != b->whole) {
+    return a->whole < b->whole ? -1 : 1;
+  }
+  if (a->frac != b->frac) {
+    return a->frac < b->frac ? -1 : 1;
+  }
+  return 0;
+}
+
+struct rational d_to_rational(struct dyadic a) {
+  if (a.frac == 0) {
+    return r_from(a.whole);
+  }
+  const int zeros = __builtin_ctzll(a.frac);
+  const int bits = D_FRACTION_BITS - zeros;
+  long long p;
+  if (bits > 62 ||
+      __builtin_mul_overflow(a.whole, 1LL << bits, &p) ||
+      __builtin_add_overflow(p, (long long) (a.frac >> zeros), &p)) {
+    fprintf(stderr, "position with %d fractional bits does not fit a 64-bit p/q\n", bits);
+    exit(-1);
+  }
+  return r_new(p, 1LL << bits);
+}
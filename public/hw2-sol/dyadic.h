@@ -0,0 +1,82 @@
+#pragma once
+
+#include "rational.h"
+
+#define D_FRACTION_BITS 64
+
+/*
+ * A dyadic rational whole + frac / 2^64. Parking positions are integers or repeated midpoints, so
+ * their denominators are powers of two and fit this fixed-point form exactly: midpoints are a shift,
+ * comparisons are integer comparisons, and no gcd is needed until the position is printed.
+ */
+struct dyadic {
+  long long whole;
+  unsigned long long frac;
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                          DYADIC FROM
+ *
+ * Description: Creates a dyadic number from an integer.
+ *
+ * Arguments: whole   The integer to convert.
+ *
+ * Returns: A dyadic number representing whole.
+ *
+ * Notes: None.
+ *********************************************************************************************************
+ */
+struct dyadic d_from(long long whole);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                          DYADIC MID
+ *
+ * Description: Computes the midpoint of two dyadic numbers.
+ *
+ * Arguments: a, b   The two dyadic numbers.
+ *
+ * Returns: A dyadic number representing (a + b) / 2.
+ *
+ * Notes: Exact as long as the result needs at most D_FRACTION_BITS fractional bits. Errors with a
+ *        message naming the limit if the midpoint chain gets deeper than that.
+ *********************************************************************************************************
+ */
+struct dyadic d_mid(struct dyadic a, struct dyadic b);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                          DYADIC CMP
+ *
+ * Description: Compares two dyadic numbers.
+ *
+ * Arguments: a, b   Pointers to the dyadic numbers to compare.
+ *
+ * Returns: -1 if a < b, 0 if a = b, 1 if a > b.
+ *
+ * Notes: Compares the integer parts, then the fractions. No multiplication is involved. The slot
+ *        engine compares its whole and frac lanes directly, so this is only the reference that
+ *        bench/rational_chain.c checks r_cmp against.
+ *********************************************************************************************************
+ */
+int d_cmp(const struct dyadic *a, const struct dyadic *b);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                      DYADIC TO RATIONAL
+ *
+ * Description: Converts a dyadic number to an irreducible rational number.
+ *
+ * Arguments: a   The dyadic number to convert.
+ *
+ * Returns: A rational number p/q equal to a, with q a power of two and p odd unless q is 1.
+ *
+ * Notes: Meant for output only. Errors if p or q does not fit in a signed 64-bit integer.
+ *********************************************************************************************************
+ */
+struct rational d_to_rational(struct dyadic a);
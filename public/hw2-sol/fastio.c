@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "fastio.h"
+
+#define FR_INITIAL_CAPACITY (1 << 20)
+
+struct fast_reader fr_open(int fd) {
+  struct fast_reader in = {NULL, 0, 0, false, false};
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    void *map = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      in.data = (char*) map;
+      in.size = (size_t) info.st_size;
+      in.mapped = true;
+      return in;
+    }
+  }
+  size_t capacity = FR_INITIAL_CAPACITY;
+  in.data = (char*) malloc(capacity);
+  while (true) {
+    if (in.size == capacity) {
+      capacity *= 2;
+      in.data = (char*) realloc(in.data, capacity);
+    }
+    if (in.data == NULL) {
+      fprintf(stderr, "out of memory while reading input\n");
+      exit(-1);
+    }
+    const ssize_t got = read(fd, in.data + in.size, capacity - in.size);
+    if (got < 0) {
+      perror("read");
+      exit(-1);
+    }
+    if (got == 0) {
+      break;
+    }
+    in.size += (size_t) got;
+  }
+  return in;
+}
+
+void fr_close(struct fast_reader *in) {
+  if (in->mapped) {
+    munmap(in->data, in->size);
+  } else {
+    free(in->data);
+  }
+  in->data = NULL;
+  in->size = in->pos = 0;
+  in->mapped = in->binary = false;
+}
+
+bool fr_expect_magic(struct fast_reader *in, const char *magic) {
+  const size_t length = strlen(magic);
+  if (in->size - in->pos <= length || memcmp(in->data + in->pos, magic, length) != 0) {
+    return false;
+  }
+  const int version = (unsigned char) in->data[in->pos + length];
+  if (version != BINARY_VERSION) {
+    fprintf(stderr, "%s stream version %d is not supported (expected %d)\n", magic, version,
+        BINARY_VERSION);
+    exit(-1);
+  }
+  in->pos += length + 1;
+  in->binary = true;
+  return true;
+}
+
+/*
+ * Decodes one zigzag LEB128 varint.
+ */
+static long long fr_next_varint(struct fast_reader *in) {
+  unsigned long long value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (in->pos >= in->size) {
+      fprintf(stderr, "binary input ends inside a number\n");
+      exit(-1);
+    }
+    const unsigned char byte = (unsigned char) in->data[in->pos++];
+    value |= (unsigned long long) (byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return (long long) (value >> 1) ^ -(long long) (value & 1);
+    }
+  }
+  fprintf(stderr, "varint at byte %zu of the input is longer than 64 bits\n", in->pos);
+  exit(-1);
+}
+
+long long fr_next_ll(struct fast_reader *in) {
+  if (in->binary) {
+    return fr_next_varint(in);
+  }
+  const char *data = in->data;
+  size_t pos = in->pos;
+  while (pos < in->size && (data[pos] == ' ' || data[pos] == '\n' || data[pos] == '\r' ||
+      data[pos] == '\t')) {
+    pos++;
+  }
+  bool negative = false;
+  if (pos < in->size && data[pos] == '-') {
+    negative = true;
+    pos++;
+  }
+  if (pos >= in->size || (unsigned) (data[pos] - '0') > 9) {
+    fprintf(stderr, "expected an integer at byte %zu of the input\n", pos);
+    exit(-1);
+  }
+  unsigned long long value = 0;
+  while (pos < in->size && (unsigned) (data[pos] - '0') <= 9) {
+    value = value * 10 + (unsigned) (data[pos] - '0');
+    pos++;
+  }
+  in->pos = pos;
+  return negative ? -(long long) value : (long long) value;
+}
+
+size_t fr_next_size(struct fast_reader *in) {
+  const long long value = fr_next_ll(in);
+  if (value < 0) {
+    fprintf(stderr, "expected a non-negative integer, got %lld\n", value);
+    exit(-1);
+  }
+  return (size_t) value;
+}
+
+int fr_next_op(struct fast_reader *in) {
+  if (!in->binary) {
+    return (int) fr_next_ll(in);
+  }
+  if (in->pos >= in->size) {
+    fprintf(stderr, "binary input ends before an operation\n");
+    exit(-1);
+  }
+  return (unsigned char) in->data[in->pos++];
+}
+
+bool fr_at_end(struct fast_reader *in) {
+  if (!in->binary) {
+    while (in->pos < in->size && (in->data[in->pos] == ' ' || in->data[in->pos] == '\n' ||
+        in->data[in->pos] == '\r' || in->data[in->pos] == '\t')) {
+      in->pos++;
+    }
+  }
+  return in->pos >= in->size;
+}
+
+struct fast_writer fw_new(int fd) {
+  struct fast_writer out = {(char*) malloc(FW_BUFFER_SIZE), 0, fd, false};
+  if (out.data == NULL) {
+    fprintf(stderr, "out of memory while creating the output buffer\n");
+    exit(-1);
+  }
+  return out;
+}
+
+void fw_delete(struct fast_writer *out) {
+  fw_flush(out);
+  free(out->data);
+  out->data = NULL;
+  out->size = 0;
+  out->fd = -1;
+}
+
+void fw_flush(struct fast_writer *out) {
+  size_t done = 0;
+  while (done < out->size) {
+    const ssize_t put = write(out->fd, out->data + done, out->size - done);
+    if (put < 0) {
+      perror("write");
+      exit(-1);
+    }
+    done += (size_t) put;
+  }
+  out->size = 0;
+}
+
+void fw_start_binary(struct fast_writer *out, const char *magic) {
+  fw_put_str(out, magic);
+  if (out->size == FW_BUFFER_SIZE) {
+    fw_flush(out);
+  }
+  out->data[out->size++] = (char) BINARY_VERSION;
+  out->binary = true;
+}
+
+void fw_put_str(struct fast_writer *out, const char *str) {
+  for (; *str; ++str) {
+    if (out->size == FW_BUFFER_SIZE) {
+      fw_flush(out);
+    }
+    out->data[out->size++] = *str;
+  }
+}
+
+void fw_put_ll(struct fast_writer *out, long long value) {
+  // 20 digits and a sign cover every long long
+  if (out->size + 21 > FW_BUFFER_SIZE) {
+    fw_flush(out);
+  }
+  if (out->binary) {
+    // Zigzag keeps small negative numbers short: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+    unsigned long long zigzag = ((unsigned long long) value << 1) ^ (unsigned long long) (value >> 63);
+    while (zigzag >= 0x80) {
+      out->data[out->size++] = (char) (zigzag | 0x80);
+      zigzag >>= 7;
+    }
+    out->data[out->size++] = (char) zigzag;
+    return;
+  }
+  unsigned long long magnitude = (unsigned long long) value;
+  if (value < 0) {
+    out->data[out->size++] = '-';
+    magnitude = -magnitude;
+  }
+  char digits[20];
+  int count = 0;
+  do {
+    digits[count++] = (char) ('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+  while (count > 0) {
+    out->data[out->size++] = digits[--count];
+  }
+}
+
+void fw_put_fraction(struct fast_writer *out, long long p, long long q) {
+  fw_put_ll(out, p);
+  if (out->binary) {
+    fw_put_ll(out, q);
+  } else if (q != 1) {
+    fw_put_str(out, "/");
+    fw_put_ll(out, q);
+  }
+}
+
+void fw_put_op(struct fast_writer *out, int op) {
+  if (!out->binary) {
+    fw_put_ll(out, op);
+    return;
+  }
+  if (out->size == FW_BUFFER_SIZE) {
+    fw_flush(out);
+  }
+  out->data[out->size++] = (char) op;
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define FW_BUFFER_SIZE (1 << 16)
+
+/*
+ * Binary streams start with a four-byte magic and a version byte. After that every number is a
+ * zigzag LEB128 varint, except operation types, which are one raw byte each.
+ *
+ * An operation log (OPLOG_MAGIC) holds exactly the values of the text input in the same order:
+ * n m q, n capacities, m delays, n - 1 edges x y w, then q operations, each an operation type
+ * followed by its operands. A result stream (RESULT_MAGIC) holds one record per printed line:
+ *   PARK       s x p q     (q is 1 for integer positions)
+ *   MOVE       s y t
+ *   REARRANGE  x count
+ *   FETCH      t count
+ */
+#define OPLOG_MAGIC "BPTL"
+#define RESULT_MAGIC "BPTR"
+#define BINARY_VERSION 1
+
+/*
+ * The whole input, either mapped from a regular file or read() into one growing buffer from a pipe.
+ * Numbers are parsed in place, so no stdio call is made per value.
+ */
+struct fast_reader {
+  char *data;
+  size_t size, pos;
+  bool mapped;
+  bool binary;  // numbers are varints, set by fr_expect_magic
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        FAST READER OPEN
+ *
+ * Description: Loads everything readable from a file descriptor.
+ *
+ * Arguments: fd   The file descriptor to read, usually 0 for stdin.
+ *
+ * Returns: A newly created struct fast_reader instance positioned at the first byte.
+ *
+ * Notes: Regular files are mapped with mmap; anything else is read() until end of file.
+ *        The caller is responsible for releasing it with fr_close.
+ *********************************************************************************************************
+ */
+struct fast_reader fr_open(int fd);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        FAST READER CLOSE
+ *
+ * Description: Releases the buffer or mapping held by a reader.
+ *
+ * Arguments: in   Pointer to the reader to close.
+ *
+ * Returns: void
+ *
+ * Notes: Sets all fields of the reader to 0 or NULL.
+ *********************************************************************************************************
+ */
+void fr_close(struct fast_reader *in);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    FAST READER EXPECT MAGIC
+ *
+ * Description: Checks whether the unread input starts with a binary stream header.
+ *
+ * Arguments: in      Pointer to the reader.
+ *            magic   The four-byte magic, OPLOG_MAGIC or RESULT_MAGIC.
+ *
+ * Returns: true if the header was found and consumed, false if the input is left untouched.
+ *
+ * Notes: On success the reader switches to binary numbers. Exits with an error message if the
+ *        magic matches but the version does not.
+ *********************************************************************************************************
+ */
+bool fr_expect_magic(struct fast_reader *in, const char *magic);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                      FAST READER NEXT LL
+ *
+ * Description: Parses the next integer.
+ *
+ * Arguments: in   Pointer to the reader.
+ *
+ * Returns: The integer, with an optional leading '-' in text.
+ *
+ * Notes: Text skips any whitespace before the number; binary decodes one varint. Exits with an
+ *        error message if the input ends or the next token is not a number.
+ *********************************************************************************************************
+ */
+long long fr_next_ll(struct fast_reader *in);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                     FAST READER NEXT SIZE
+ *
+ * Description: Parses the next non-negative decimal integer.
+ *
+ * Arguments: in   Pointer to the reader.
+ *
+ * Returns: The integer as a size_t.
+ *
+ * Notes: Exits with an error message on a negative number, as fr_next_ll does on malformed input.
+ *********************************************************************************************************
+ */
+size_t fr_next_size(struct fast_reader *in);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                      FAST READER NEXT OP
+ *
+ * Description: Reads the next operation type.
+ *
+ * Arguments: in   Pointer to the reader.
+ *
+ * Returns: The operation type.
+ *
+ * Notes: One raw byte in binary, a decimal integer in text.
+ *********************************************************************************************************
+ */
+int fr_next_op(struct fast_reader *in);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       FAST READER AT END
+ *
+ * Description: Checks whether only whitespace is left in the input.
+ *
+ * Arguments: in   Pointer to the reader.
+ *
+ * Returns: true if nothing more can be read.
+ *
+ * Notes: Skips the whitespace it passes over.
+ *********************************************************************************************************
+ */
+bool fr_at_end(struct fast_reader *in);
+
+/*
+ * Output collected in a fixed buffer and handed to write() in FW_BUFFER_SIZE chunks.
+ */
+struct fast_writer {
+  char *data;
+  size_t size;
+  int fd;
+  bool binary;  // numbers are varints, set by fw_start_binary
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        FAST WRITER NEW
+ *
+ * Description: Creates a writer for a file descriptor.
+ *
+ * Arguments: fd   The file descriptor to write, usually 1 for stdout.
+ *
+ * Returns: A newly created struct fast_writer instance.
+ *
+ * Notes: The caller is responsible for flushing and freeing it with fw_delete.
+ *********************************************************************************************************
+ */
+struct fast_writer fw_new(int fd);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       FAST WRITER DELETE
+ *
+ * Description: Flushes and frees a writer.
+ *
+ * Arguments: out   Pointer to the writer to delete.
+ *
+ * Returns: void
+ *
+ * Notes: Sets all fields of the writer to 0 or NULL after freeing the memory.
+ *********************************************************************************************************
+ */
+void fw_delete(struct fast_writer *out);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       FAST WRITER FLUSH
+ *
+ * Description: Writes everything buffered so far.
+ *
+ * Arguments: out   Pointer to the writer.
+ *
+ * Returns: void
+ *
+ * Notes: Retries short writes; exits with an error message if write() fails.
+ *********************************************************************************************************
+ */
+void fw_flush(struct fast_writer *out);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    FAST WRITER START BINARY
+ *
+ * Description: Writes a binary stream header and switches the writer to binary numbers.
+ *
+ * Arguments: out     Pointer to the writer.
+ *            magic   The four-byte magic, OPLOG_MAGIC or RESULT_MAGIC.
+ *
+ * Returns: void
+ *
+ * Notes: Call before anything else is written.
+ *********************************************************************************************************
+ */
+void fw_start_binary(struct fast_writer *out, const char *magic);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        FAST WRITER PUT STR
+ *
+ * Description: Appends a NUL-terminated string.
+ *
+ * Arguments: out   Pointer to the writer.
+ *            str   The string to append.
+ *
+ * Returns: void
+ *
+ * Notes: Strings longer than the buffer are split across flushes.
+ *********************************************************************************************************
+ */
+void fw_put_str(struct fast_writer *out, const char *str);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        FAST WRITER PUT LL
+ *
+ * Description: Appends a signed integer, in decimal or as a varint.
+ *
+ * Arguments: out     Pointer to the writer.
+ *            value   The integer to append.
+ *
+ * Returns: void
+ *
+ * Notes: Text matches printf("%lld"), including LLONG_MIN. Nothing separates consecutive numbers.
+ *********************************************************************************************************
+ */
+void fw_put_ll(struct fast_writer *out, long long value);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                     FAST WRITER PUT FRACTION
+ *
+ * Description: Appends p/q, or only p when q is 1. Binary always appends both numbers.
+ *
+ * Arguments: out   Pointer to the writer.
+ *            p     The numerator.
+ *            q     The denominator.
+ *
+ * Returns: void
+ *
+ * Notes: Prints the numbers as given; reducing the fraction is up to the caller.
+ *********************************************************************************************************
+ */
+void fw_put_fraction(struct fast_writer *out, long long p, long long q);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        FAST WRITER PUT OP
+ *
+ * Description: Appends an operation type.
+ *
+ * Arguments: out   Pointer to the writer.
+ *            op    The operation type.
+ *
+ * Returns: void
+ *
+ * Notes: One raw byte in binary, a decimal integer in text.
+ *********************************************************************************************************
+ */
+void fw_put_op(struct fast_writer *out, int op);
@@ -0,0 +1,321 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dyadic.h"
+#include "bicycle.h"
+#include "large_slot.h"
+
+#define LS_NIL (-1)
+
+struct large_slot ls_new(size_t capacity) {
+  struct large_slot new_slot = {
+    .nodes = NULL,
+    .nodes_size = 0,
+    .nodes_capacity = 0,
+    .free_node = LS_NIL,
+    .bicycles = LS_NIL,
+    .runs = LS_NIL,
+    .fractional = NULL,
+    .fractional_size = 0,
+    .fractional_capacity = 0,
+    .size = 0,
+    .integers = 0,
+    .capacity = capacity,
+    .seed = 2463534242u};
+  return new_slot;
+}
+
+void ls_delete(struct large_slot *slot) {
+  free(slot->nodes);
+  free(slot->fractional);
+  *slot = ls_new(0);
+}
+
+/*
+ * Takes a node from the free list or the end of the pool and gives it key (whole, frac).
+ */
+static int ls_node_new(struct large_slot *slot, long long whole, unsigned long long frac) {
+  int index = slot->free_node;
+  if (index != LS_NIL) {
+    slot->free_node = slot->nodes[index].left;
+  } else {
+    if (slot->nodes_size == slot->nodes_capacity) {
+      slot->nodes_capacity = slot->nodes_capacity ? slot->nodes_capacity * 2 : 16;
+      slot->nodes = (struct ls_node*) realloc(slot->nodes,
+          sizeof(struct ls_node) * slot->nodes_capacity);
+      if (slot->nodes == NULL) {
+        fprintf(stderr, "out of memory for %zu large slot nodes\n", slot->nodes_capacity);
+        exit(-1);
+      }
+    }
+    index = (int) slot->nodes_size++;
+  }
+  slot->seed ^= slot->seed << 13;
+  slot->seed ^= slot->seed >> 17;
+  slot->seed ^= slot->seed << 5;
+  struct ls_node *node = &slot->nodes[index];
+  node->whole = whole;
+  node->frac = frac;
+  node->end = whole;
+  node->owner = -1;
+  node->fractional_at = -1;
+  node->left = node->right = LS_NIL;
+  node->priority = slot->seed;
+  return index;
+}
+
+static void ls_node_free(struct large_slot *slot, int index) {
+  slot->nodes[index].owner = -1;
+  slot->nodes[index].left = slot->free_node;
+  slot->free_node = index;
+}
+
+/*
+ * Compares the key of a node with (whole, frac).
+ */
+static int ls_cmp(const struct ls_node *node, long long whole, unsigned long long frac) {
+  if (node->whole != whole) {
+    return node->whole < whole ? -1 : 1;
+  }
+  if (node->frac != frac) {
+    return node->frac < frac ? -1 : 1;
+  }
+  return 0;
+}
+
+/*
+ * Splits the tree at root into the keys before (whole, frac) and the rest. With inclusive, a key
+ * equal to (whole, frac) goes to the left part.
+ */
+static void ls_split(struct large_slot *slot, int root, long long whole, unsigned long long frac,
+    bool inclusive, int *left, int *right) {
+  if (root == LS_NIL) {
+    *left = *right = LS_NIL;
+    return;
+  }
+  struct ls_node *node = &slot->nodes[root];
+  const int c = ls_cmp(node, whole, frac);
+  if (c < 0 || (c == 0 && inclusive)) {
+    ls_split(slot, node->right, whole, frac, inclusive, &node->right, right);
+    *left = root;
+  } else {
+    ls_split(slot, node->left, whole, frac, inclusive, left, &node->left);
+    *right = root;
+  }
+}
+
+/*
+ * Joins two trees where every key of a is before every key of b.
+ */
+static int ls_merge(struct large_slot *slot, int a, int b) {
+  if (a == LS_NIL) {
+    return b;
+  }
+  if (b == LS_NIL) {
+    return a;
+  }
+  if (slot->nodes[a].priority > slot->nodes[b].priority) {
+    slot->nodes[a].right = ls_merge(slot, slot->nodes[a].right, b);
+    return a;
+  }
+  slot->nodes[b].left = ls_merge(slot, a, slot->nodes[b].left);
+  return b;
+}
+
+static void ls_attach(struct large_slot *slot, int *root, int index) {
+  int left, right;
+  ls_split(slot, *root, slot->nodes[index].whole, slot->nodes[index].frac, false, &left, &right);
+  *root = ls_merge(slot, ls_merge(slot, left, index), right);
+}
+
+static void ls_detach(struct large_slot *slot, int *root, int index) {
+  int left, middle, right;
+  ls_split(slot, *root, slot->nodes[index].whole, slot->nodes[index].frac, false, &left, &right);
+  ls_split(slot, right, slot->nodes[index].whole, slot->nodes[index].frac, true, &middle, &right);
+  *root = ls_merge(slot, left, right);
+}
+
+/*
+ * The node with the greatest key not after (whole, frac) (or, without inclusive, before it), or
+ * LS_NIL if there is none.
+ */
+static int ls_floor(const struct large_slot *slot, int root, long long whole,
+    unsigned long long frac, bool inclusive) {
+  int found = LS_NIL;
+  while (root != LS_NIL) {
+    const int c = ls_cmp(&slot->nodes[root], whole, frac);
+    if (c < 0 || (c == 0 && inclusive)) {
+      found = root;
+      root = slot->nodes[root].right;
+    } else {
+      root = slot->nodes[root].left;
+    }
+  }
+  return found;
+}
+
+/*
+ * The node with the smallest key after (whole, frac), or LS_NIL if there is none.
+ */
+static int ls_higher(const struct large_slot *slot, int root, long long whole,
+    unsigned long long frac) {
+  int found = LS_NIL;
+  while (root != LS_NIL) {
+    if (ls_cmp(&slot->nodes[root], whole, frac) > 0) {
+      found = root;
+      root = slot->nodes[root].left;
+    } else {
+      root = slot->nodes[root].right;
+    }
+  }
+  return found;
+}
+
+/*
+ * Marks integer position p occupied, joining it to the runs that end at p - 1 or start at p + 1.
+ * Moving the start of a run to an adjacent free position keeps the run tree ordered, so the
+ * neighbouring cases rewrite keys in place.
+ */
+static void ls_occupy(struct large_slot *slot, long long p) {
+  const int below = ls_floor(slot, slot->runs, p - 1, 0, true);
+  const int above = ls_floor(slot, slot->runs, p + 1, 0, true);
+  const bool joins_below = below != LS_NIL && slot->nodes[below].end == p - 1;
+  const bool joins_above = above != LS_NIL && slot->nodes[above].whole == p + 1;
+  if (joins_below && joins_above) {
+    slot->nodes[below].end = slot->nodes[above].end;
+    ls_detach(slot, &slot->runs, above);
+    ls_node_free(slot, above);
+  } else if (joins_below) {
+    slot->nodes[below].end = p;
+  } else if (joins_above) {
+    slot->nodes[above].whole = p;
+  } else {
+    ls_attach(slot, &slot->runs, ls_node_new(slot, p, 0));
+  }
+  slot->integers++;
+}
+
+/*
+ * Marks integer position p vacant, shrinking or splitting the run that holds it.
+ */
+static void ls_vacate(struct large_slot *slot, long long p) {
+  const int run = ls_floor(slot, slot->runs, p, 0, true);
+  const long long first = slot->nodes[run].whole, last = slot->nodes[run].end;
+  if (first == last) {
+    ls_detach(slot, &slot->runs, run);
+    ls_node_free(slot, run);
+  } else if (first == p) {
+    slot->nodes[run].whole = p + 1;
+  } else {
+    slot->nodes[run].end = p - 1;
+    if (last != p) {
+      const int rest = ls_node_new(slot, p + 1, 0);
+      slot->nodes[rest].end = last;
+      ls_attach(slot, &slot->runs, rest);
+    }
+  }
+  slot->integers--;
+}
+
+struct dyadic ls_insert(struct large_slot *slot, int owner, size_t target_location,
+    struct ps_record *records) {
+  // Case 1 & 2: park at the target, or just outside the run of occupied positions holding it
+  const long long target = (long long) target_location;
+  long long position = target;
+  const int run = ls_floor(slot, slot->runs, target, 0, true);
+  if (run != LS_NIL && slot->nodes[run].end >= target) {
+    position = 0;
+    if (slot->integers < slot->capacity) {
+      const long long left = slot->nodes[run].whole - 1, right = slot->nodes[run].end + 1;
+      const bool right_fits = right <= (long long) slot->capacity;
+      position = left >= 1 && (!right_fits || target - left <= right - target) ? left : right;
+    }
+  }
+  struct dyadic location;
+  if (position != 0) {
+    location = d_from(position);
+    ls_occupy(slot, position);
+  } else {
+    // Case 3: no vacancies, take the middle between the target and the bicycle before it, or the
+    // one after it if the target holds the first bicycle
+    int neighbour = ls_floor(slot, slot->bicycles, target, 0, false);
+    if (neighbour == LS_NIL) {
+      neighbour = ls_higher(slot, slot->bicycles, target, 0);
+    }
+    if (neighbour == LS_NIL) {
+      fprintf(stderr, "Logic error: a full slot should hold more than one bicycle\n");
+      exit(EXIT_FAILURE);
+    }
+    struct dyadic other = { .whole = slot->nodes[neighbour].whole, .frac = slot->nodes[neighbour].frac };
+    location = d_mid(d_from(target), other);
+  }
+
+  const int index = ls_node_new(slot, location.whole, location.frac);
+  slot->nodes[index].owner = owner;
+  if (location.frac != 0) {
+    if (slot->fractional_size == slot->fractional_capacity) {
+      slot->fractional_capacity = slot->fractional_capacity ? slot->fractional_capacity * 2 : 16;
+      slot->fractional = (int*) realloc(slot->fractional, sizeof(int) * slot->fractional_capacity);
+      if (slot->fractional == NULL) {
+        fprintf(stderr, "out of memory for %zu fractional bicycles\n", slot->fractional_capacity);
+        exit(-1);
+      }
+    }
+    slot->nodes[index].fractional_at = (int) slot->fractional_size;
+    slot->fractional[slot->fractional_size++] = index;
+  }
+  ls_attach(slot, &slot->bicycles, index);
+  slot->size++;
+  records[owner].rank = index;
+  return location;
+}
+
+int ls_erase(struct large_slot *slot, int target_id, struct ps_record *records) {
+  const int index = records[target_id].rank;
+  if (index < 0 || (size_t) index >= slot->nodes_size || slot->nodes[index].owner != target_id) {
+    return -1;
+  }
+  struct ls_node *node = &slot->nodes[index];
+  if (node->frac == 0) {
+    ls_vacate(slot, node->whole);
+    node = &slot->nodes[index];  // ls_vacate may grow the pool
+  } else {
+    const int last = slot->fractional[--slot->fractional_size];
+    slot->fractional[node->fractional_at] = last;
+    slot->nodes[last].fractional_at = node->fractional_at;
+  }
+  ls_detach(slot, &slot->bicycles, index);
+  ls_node_free(slot, index);
+  slot->size--;
+  return 0;
+}
+
+size_t ls_clear(struct large_slot *slot, int *owners) {
+  // Run nodes and free nodes have no owner, so the pool can be scanned instead of the tree
+  size_t count = 0;
+  for (size_t i = 0; i < slot->nodes_size; ++i) {
+    if (slot->nodes[i].owner >= 0) {
+      owners[count++] = slot->nodes[i].owner;
+    }
+  }
+  slot->nodes_size = 0;
+  slot->free_node = LS_NIL;
+  slot->bicycles = slot->runs = LS_NIL;
+  slot->fractional_size = 0;
+  slot->size = slot->integers = 0;
+  return count;
+}
+
+size_t ls_rearrange(struct large_slot *slot, int *owners) {
+  const size_t count = slot->fractional_size;
+  for (size_t i = 0; i < count; ++i) {
+    const int index = slot->fractional[i];
+    owners[i] = slot->nodes[index].owner;
+    ls_detach(slot, &slot->bicycles, index);
+    ls_node_free(slot, index);
+  }
+  slot->fractional_size = 0;
+  slot->size -= count;
+  return count;
+}
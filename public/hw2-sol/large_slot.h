@@ -0,0 +1,147 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "dyadic.h"
+
+struct ps_record;
+
+/*
+ * A node of either tree of a large slot. In the bicycle tree the key is the bicycle's location; in
+ * the run tree the key is the first position of a maximal run of occupied integer positions
+ * (frac 0) and end is its last position. Free nodes are chained through left.
+ */
+struct ls_node {
+  long long whole;
+  unsigned long long frac;
+  long long end;       // run tree: last occupied position of the run
+  int owner;           // bicycle tree: the owner, -1 in the run tree
+  int fractional_at;   // bicycle tree: index in fractional, -1 for integer locations
+  int left, right;
+  unsigned priority;
+};
+
+/*
+ * A parking slot whose capacity is too large for the inline lanes of struct ps. The bicycles are
+ * kept in a treap ordered by location, and the occupied integer positions as a treap of maximal
+ * runs, so the vacancy nearest to a target is just outside the run holding it. Both trees share one
+ * node pool and refer to nodes by index, and the indices of fractional bicycles are kept in an
+ * unordered array for REARRANGE. Everything costs O(log k) for k bicycles, whatever the capacity.
+ */
+struct large_slot {
+  struct ls_node *nodes;
+  size_t nodes_size, nodes_capacity;
+  int free_node;        // head of the free list, -1 if empty
+  int bicycles, runs;   // tree roots, -1 if empty
+  int *fractional;
+  size_t fractional_size, fractional_capacity;
+  size_t size;          // number of bicycles
+  size_t integers;      // number of occupied integer positions
+  size_t capacity;
+  unsigned seed;        // xorshift state for node priorities
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        LARGE SLOT NEW
+ *
+ * Description: Creates an empty large slot.
+ *
+ * Arguments: capacity   The number of integer positions, 1 ... capacity.
+ *
+ * Returns: A newly created struct large_slot instance.
+ *
+ * Notes: No memory is taken until the first bicycle parks. The caller is responsible for freeing
+ *        the memory using ls_delete.
+ *********************************************************************************************************
+ */
+struct large_slot ls_new(size_t capacity);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       LARGE SLOT DELETE
+ *
+ * Description: Frees the memory held by a large slot.
+ *
+ * Arguments: slot   Pointer to the large slot to delete.
+ *
+ * Returns: void
+ *
+ * Notes: Sets all fields of the slot to 0, NULL or -1.
+ *********************************************************************************************************
+ */
+void ls_delete(struct large_slot *slot);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       LARGE SLOT INSERT
+ *
+ * Description: Parks a bicycle by the same policy as ps_insert.
+ *
+ * Arguments: slot             Pointer to the large slot.
+ *            owner            ID of the bicycle owner.
+ *            target_location  The intended parking position.
+ *            records          Per-owner records; records[owner].rank is set to the bicycle's node.
+ *
+ * Returns: The final position of the bicycle as a dyadic number.
+ *
+ * Notes: Node indices never move, so unlike the inline lanes no other record changes.
+ *********************************************************************************************************
+ */
+struct dyadic ls_insert(struct large_slot *slot, int owner, size_t target_location,
+    struct ps_record *records);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       LARGE SLOT ERASE
+ *
+ * Description: Removes the bicycle of an owner.
+ *
+ * Arguments: slot       Pointer to the large slot.
+ *            target_id  The ID of the bicycle owner to remove.
+ *            records    Per-owner records; records[target_id].rank names the node.
+ *
+ * Returns: 0 on success, -1 if the bicycle is not found.
+ *
+ * Notes: None.
+ *********************************************************************************************************
+ */
+int ls_erase(struct large_slot *slot, int target_id, struct ps_record *records);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       LARGE SLOT CLEAR
+ *
+ * Description: Removes every bicycle.
+ *
+ * Arguments: slot     Pointer to the large slot.
+ *            owners   Receives the owners of the removed bicycles; needs room for slot->size.
+ *
+ * Returns: The number of bicycles removed.
+ *
+ * Notes: The node pool is kept for the next bicycles.
+ *********************************************************************************************************
+ */
+size_t ls_clear(struct large_slot *slot, int *owners);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                     LARGE SLOT REARRANGE
+ *
+ * Description: Removes every bicycle at a non-integer location.
+ *
+ * Arguments: slot     Pointer to the large slot.
+ *            owners   Receives the owners of the removed bicycles; needs room for slot->size.
+ *
+ * Returns: The number of bicycles removed.
+ *
+ * Notes: O(log k) per removed bicycle; integer bicycles and the run tree are not visited.
+ *********************************************************************************************************
+ */
+size_t ls_rearrange(struct large_slot *slot, int *owners);
@@ -0,0 +1,133 @@
+/*
+ * Converts between the text input format and the binary operation log described in fastio.h, and
+ * renders binary result streams as the text the checker expects.
+ *
+ *   ./oplog encode  < trace.in   > trace.bin
+ *   ./oplog decode  < trace.bin  > trace.in
+ *   ./oplog results < result.bin > result.out
+ *
+ * ./answer < trace.bin writes a result stream instead of text.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fastio.h"
+#include "bpt.h"
+#include "report.h"
+
+// Operand count of each operation type, indexed like enum Operation in bpt.h
+static const int operands[] = {3, 3, 2, 2, 1, 3};
+#define OPERATION_COUNT ((int) (sizeof(operands) / sizeof(operands[0])))
+
+static void put_values(struct fast_reader *in, struct fast_writer *out, size_t count,
+    const char *separator) {
+  for (size_t i = 0; i < count; ++i) {
+    fw_put_ll(out, fr_next_ll(in));
+    if (!out->binary) {
+      fw_put_str(out, i + 1 < count ? " " : separator);
+    }
+  }
+}
+
+/*
+ * Copies one trace from in to out value by value. The two sides differ only in how numbers are
+ * encoded, so the same walk serves both directions.
+ */
+static void convert_trace(struct fast_reader *in, struct fast_writer *out) {
+  const size_t n = fr_next_size(in), m = fr_next_size(in), q = fr_next_size(in);
+  fw_put_ll(out, (long long) n);
+  fw_put_str(out, out->binary ? "" : " ");
+  fw_put_ll(out, (long long) m);
+  fw_put_str(out, out->binary ? "" : " ");
+  fw_put_ll(out, (long long) q);
+  fw_put_str(out, out->binary ? "" : "\n");
+  put_values(in, out, n, "\n");
+  put_values(in, out, m, "\n");
+  for (size_t i = 0; i + 1 < n; ++i) {
+    put_values(in, out, 3, "\n");
+  }
+  for (size_t i = 0; i < q; ++i) {
+    const int op = fr_next_op(in);
+    if (op < 0 || op >= OPERATION_COUNT) {
+      fprintf(stderr, "operation %zu has unknown type %d\n", i, op);
+      exit(-1);
+    }
+    fw_put_op(out, op);
+    fw_put_str(out, out->binary ? "" : " ");
+    put_values(in, out, operands[op], "\n");
+  }
+}
+
+static void render_results(struct fast_reader *in, struct fast_writer *out) {
+  while (!fr_at_end(in)) {
+    const int op = fr_next_op(in);
+    switch (op) {
+      case PARK: {
+        struct park_result result;
+        result.s = (int) fr_next_ll(in);
+        result.x = fr_next_size(in);
+        result.position.p = fr_next_ll(in);
+        result.position.q = fr_next_ll(in);
+        rp_park(out, &result);
+        break;
+      }
+      case MOVE: {
+        struct move_result result;
+        result.s = (int) fr_next_ll(in);
+        result.y = fr_next_size(in);
+        result.t = fr_next_ll(in);
+        rp_move(out, &result);
+        break;
+      }
+      case REARRANGE: {
+        struct rearrange_result result;
+        result.x = fr_next_size(in);
+        result.count = fr_next_size(in);
+        rp_rearrange(out, &result);
+        break;
+      }
+      case FETCH: {
+        struct fetch_result result;
+        result.t = fr_next_ll(in);
+        result.count = fr_next_size(in);
+        rp_fetch(out, &result);
+        break;
+      }
+      default: {
+        fprintf(stderr, "result record has unknown type %d\n", op);
+        exit(-1);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s encode|decode|results < input > output\n", argv[0]);
+    return -1;
+  }
+  struct fast_reader in = fr_open(0);
+  struct fast_writer out = fw_new(1);
+  if (strcmp(argv[1], "encode") == 0) {
+    fw_start_binary(&out, OPLOG_MAGIC);
+    convert_trace(&in, &out);
+  } else if (strcmp(argv[1], "decode") == 0) {
+    if (!fr_expect_magic(&in, OPLOG_MAGIC)) {
+      fprintf(stderr, "input is not a binary operation log\n");
+      exit(-1);
+    }
+    convert_trace(&in, &out);
+  } else if (strcmp(argv[1], "results") == 0) {
+    if (!fr_expect_magic(&in, RESULT_MAGIC)) {
+      fprintf(stderr, "input is not a binary result stream\n");
+      exit(-1);
+    }
+    render_results(&in, &out);
+  } else {
+    fprintf(stderr, "unknown mode %s\n", argv[1]);
+    exit(-1);
+  }
+  fw_delete(&out);
+  fr_close(&in);
+}
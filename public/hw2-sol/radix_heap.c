@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "radix_heap.h"
+
+/*
+ * Maps a signed time to an unsigned key with the same order.
+ */
+static unsigned long long rh_key(long long t) {
+  return (unsigned long long) t ^ (1ULL << 63);
+}
+
+static int rh_bucket_of(const struct radix_heap *h, unsigned long long key) {
+  return key == h->last ? 0 : 64 - __builtin_clzll(key ^ h->last);
+}
+
+static void rh_append(struct radix_heap *h, int b, struct sy_info info, unsigned long long key) {
+  if (h->size[b] == h->capacity[b]) {
+    h->capacity[b] = h->capacity[b] ? h->capacity[b] * 2 : 16;
+    h->bucket[b] = (struct sy_info*) realloc(h->bucket[b], sizeof(struct sy_info) * h->capacity[b]);
+    if (h->bucket[b] == NULL) {
+      fprintf(stderr, "out of memory in radix heap bucket %d\n", b);
+      exit(-1);
+    }
+  }
+  if (h->size[b] == 0 || key < h->min[b]) {
+    h->min[b] = key;
+  }
+  h->bucket[b][h->size[b]++] = info;
+}
+
+struct radix_heap rh_new(void) {
+  struct radix_heap h;
+  memset(&h, 0, sizeof(h));
+  return h;
+}
+
+void rh_delete(struct radix_heap *h) {
+  for (int b = 0; b < RH_BUCKETS; ++b) {
+    free(h->bucket[b]);
+  }
+  memset(h, 0, sizeof(*h));
+}
+
+void rh_push(struct radix_heap *h, struct sy_info info) {
+  const unsigned long long key = rh_key(info.t);
+  if (key < h->last) {
+    fprintf(stderr, "radix heap key %lld is below the last drained minimum\n", info.t);
+    exit(-1);
+  }
+  rh_append(h, rh_bucket_of(h, key), info, key);
+  h->total++;
+}
+
+size_t rh_drain(struct radix_heap *h, long long t) {
+  const unsigned long long bound = rh_key(t);
+  size_t drained = 0;
+  while (h->total > 0) {
+    if (h->size[0] == 0) {
+      int b = 1;
+      while (h->size[b] == 0) {
+        b++;
+      }
+      // Moving last past the bound would reject later pushes between the bound and this minimum
+      if (h->min[b] > bound) {
+        break;
+      }
+      h->last = h->min[b];
+      const size_t size = h->size[b];
+      h->size[b] = 0;
+      for (size_t i = 0; i < size; ++i) {
+        const struct sy_info info = h->bucket[b][i];
+        const unsigned long long key = rh_key(info.t);
+        rh_append(h, rh_bucket_of(h, key), info, key);
+      }
+    }
+    if (h->last > bound) {
+      break;
+    }
+    drained += h->size[0];
+    h->total -= h->size[0];
+    h->size[0] = 0;
+  }
+  return drained;
+}
+
+size_t rh_size(const struct radix_heap *h) {
+  return h->total;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stddef.h>
+
+#define RH_BUCKETS 65
+
+struct sy_info {
+  int owner;
+  long long t;
+};
+
+/*
+ * A monotone priority queue of sy_info keyed on t. Bucket 0 holds keys equal to last, the most
+ * recent minimum; bucket i > 0 holds keys whose highest bit differing from last is bit i - 1. Keys
+ * pushed must not be below last, which Shuiyuan guarantees: a bicycle enters at t + delay with t
+ * after every earlier FETCH, and draining never moves last past the fetch time.
+ */
+struct radix_heap {
+  struct sy_info *bucket[RH_BUCKETS];
+  size_t size[RH_BUCKETS], capacity[RH_BUCKETS];
+  unsigned long long min[RH_BUCKETS];  // smallest key in each non-empty bucket
+  unsigned long long last;
+  size_t total;
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                         RADIX HEAP NEW
+ *
+ * Description: Creates an empty radix heap.
+ *
+ * Arguments: None.
+ *
+ * Returns: A newly created struct radix_heap instance.
+ *
+ * Notes: Buckets are allocated on first use. The caller is responsible for freeing the memory using
+ *        rh_delete.
+ *********************************************************************************************************
+ */
+struct radix_heap rh_new(void);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       RADIX HEAP DELETE
+ *
+ * Description: Frees the memory allocated for a radix heap.
+ *
+ * Arguments: h   Pointer to the heap to delete.
+ *
+ * Returns: void
+ *
+ * Notes: Sets all fields of the heap to 0 or NULL after freeing the memory.
+ *********************************************************************************************************
+ */
+void rh_delete(struct radix_heap *h);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        RADIX HEAP PUSH
+ *
+ * Description: Adds an element to the heap.
+ *
+ * Arguments: h      Pointer to the heap.
+ *            info   The element to add.
+ *
+ * Returns: void
+ *
+ * Notes: O(1). Exits with an error message if info.t is below the last drained minimum.
+ *********************************************************************************************************
+ */
+void rh_push(struct radix_heap *h, struct sy_info info);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        RADIX HEAP DRAIN
+ *
+ * Description: Removes every element whose key is at most t.
+ *
+ * Arguments: h   Pointer to the heap.
+ *            t   The inclusive bound.
+ *
+ * Returns: The number of elements removed.
+ *
+ * Notes: Whole buckets are dropped at once, and each element is redistributed at most once per bit
+ *        of key, so a drain costs amortized O(log range) per element rather than O(log n) per pop.
+ *********************************************************************************************************
+ */
+size_t rh_drain(struct radix_heap *h, long long t);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        RADIX HEAP SIZE
+ *
+ * Description: Gets the number of elements in the heap.
+ *
+ * Arguments: h   Pointer to the heap.
+ *
+ * Returns: The number of elements.
+ *
+ * Notes: None.
+ *********************************************************************************************************
+ */
+size_t rh_size(const struct radix_heap *h);
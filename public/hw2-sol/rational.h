@@ -1,17 +1,29 @@
 #pragma once
 
+/*
+ * Parking positions are dyadic (dyadic.h) and only become rationals through d_to_rational for
+ * output, so answer calls neither r_cmp nor r_avg; r_cmp is reached only through the legacy b_cmp.
+ * Both are kept for bench/rational_chain, which measures them against the dyadic kernels.
+ *
+ * Build options: by default comparisons and averages are computed exactly in 128 bits and results
+ * that do not fit back into two long longs are reported (checked). Compiling with -DRATIONAL_FAST
+ * uses plain 64-bit cross multiplication instead, which is faster but silently wraps once the
+ * denominators grow past 32 bits. The Makefile builds it only for bench/rational_chain_fast; it
+ * changes nothing in answer.
+ */
+
 /*
  *********************************************************************************************************
  *
  *                                                 GCD
  *
- * Description: Computes the greatest common divisor of two integers using Euclidean algorithm.
+ * Description: Computes the greatest common divisor of two integers using the binary GCD algorithm.
  *
  * Arguments: a, b   The two integers for which to find the GCD.
  *
- * Returns: The greatest common divisor of a and b.
+ * Returns: The greatest common divisor of a and b, which is never negative.
  *
- * Notes: Assumes that b is not 0 when the function is called.
+ * Notes: gcd(a, 0) is |a|.
  *********************************************************************************************************
  */
 long long gcd(long long a, long long b);
@@ -163,11 +175,29 @@ struct rational r_div(struct rational a, struct rational b);
  *
  * Returns: -1 if a < b, 0 if a = b, 1 if a > b.
  *
- * Notes: Comparison is done by cross multiplication to avoid precision issues.
+ * Notes: Comparison is done by cross multiplication to avoid precision issues. The products are
+ *        128-bit unless built with RATIONAL_FAST.
  *********************************************************************************************************
  */
 int r_cmp(struct rational *a, struct rational *b);
 
+/*
+ *********************************************************************************************************
+ *
+ *                                          RATIONAL AVG
+ *
+ * Description: Computes the midpoint of two rational numbers.
+ *
+ * Arguments: a, b   The two rational numbers to average.
+ *
+ * Returns: A rational number representing (a + b) / 2.
+ *
+ * Notes: The result is automatically simplified. Intermediate terms are 128-bit and the result is
+ *        checked to fit in 64 bits unless built with RATIONAL_FAST. Assumes positive denominators.
+ *********************************************************************************************************
+ */
+struct rational r_avg(struct rational a, struct rational b);
+
 /*
  *********************************************************************************************************
  *
@@ -0,0 +1,135 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ready_count.h"
+
+static void rc_add(struct ready_count *rc, int w, long long offset) {
+  for (long long i = offset + 1; i <= RC_WINDOW; i += i & -i) {
+    rc->tree[w][i - 1]++;
+  }
+}
+
+/*
+ * Number of keys at offsets [0, offset] of window w.
+ */
+static size_t rc_prefix(const struct ready_count *rc, int w, long long offset) {
+  if (offset < 0) {
+    return 0;
+  }
+  if (offset >= RC_WINDOW) {
+    return rc->total[w];
+  }
+  size_t count = 0;
+  for (long long i = offset + 1; i > 0; i -= i & -i) {
+    count += rc->tree[w][i - 1];
+  }
+  return count;
+}
+
+/*
+ * Number of keys in [base, key] over both windows.
+ */
+static size_t rc_upto(const struct ready_count *rc, long long key) {
+  return rc_prefix(rc, 0, key - rc->base) + rc_prefix(rc, 1, key - rc->base - RC_WINDOW);
+}
+
+static void rc_clear(struct ready_count *rc, int w) {
+  for (size_t k = 0; k < rc->touched_size[w]; ++k) {
+    for (long long i = rc->touched[w][k] + 1; i <= RC_WINDOW && rc->tree[w][i - 1]; i += i & -i) {
+      rc->tree[w][i - 1] = 0;
+    }
+  }
+  rc->touched_size[w] = 0;
+  rc->total[w] = 0;
+}
+
+/*
+ * Slides the windows until now falls in the first one, folding what leaves into due.
+ */
+static void rc_advance(struct ready_count *rc, long long now) {
+  while (now >= rc->base + RC_WINDOW) {
+    const size_t drained = rc->watermark >= rc->base ? rc_upto(rc, rc->watermark) : 0;
+    if (now >= rc->base + 2 * RC_WINDOW) {
+      // Every key left is below now: fold both windows and restart them at now
+      rc->due += rc->total[0] + rc->total[1] - drained;
+      rc_clear(rc, 0);
+      rc_clear(rc, 1);
+      rc->base = now;
+      break;
+    }
+    rc->due += rc->total[0] - (drained < rc->total[0] ? drained : rc->total[0]);
+    rc_clear(rc, 0);
+    unsigned *tree = rc->tree[0];
+    long long *touched = rc->touched[0];
+    const size_t capacity = rc->touched_capacity[0];
+    rc->tree[0] = rc->tree[1];
+    rc->touched[0] = rc->touched[1];
+    rc->touched_size[0] = rc->touched_size[1];
+    rc->touched_capacity[0] = rc->touched_capacity[1];
+    rc->total[0] = rc->total[1];
+    rc->tree[1] = tree;
+    rc->touched[1] = touched;
+    rc->touched_size[1] = 0;
+    rc->touched_capacity[1] = capacity;
+    rc->total[1] = 0;
+    rc->base += RC_WINDOW;
+  }
+}
+
+struct ready_count rc_new(void) {
+  struct ready_count rc;
+  memset(&rc, 0, sizeof(rc));
+  for (int w = 0; w < 2; ++w) {
+    rc.tree[w] = (unsigned*) calloc(RC_WINDOW, sizeof(unsigned));
+    if (rc.tree[w] == NULL) {
+      fprintf(stderr, "out of memory for the ready time counter\n");
+      exit(-1);
+    }
+  }
+  // Far below any time, so the first push or drain starts the windows at its own time
+  rc.base = rc.watermark = LLONG_MIN / 2;
+  return rc;
+}
+
+void rc_delete(struct ready_count *rc) {
+  for (int w = 0; w < 2; ++w) {
+    free(rc->tree[w]);
+    free(rc->touched[w]);
+  }
+  memset(rc, 0, sizeof(*rc));
+}
+
+void rc_push(struct ready_count *rc, long long now, long long key) {
+  if (key < now || key - now >= RC_WINDOW) {
+    fprintf(stderr, "ready time %lld is outside [%lld, %lld)\n", key, now, now + RC_WINDOW);
+    exit(-1);
+  }
+  rc_advance(rc, now);
+  const int w = key - rc->base >= RC_WINDOW;
+  const long long offset = key - rc->base - w * RC_WINDOW;
+  if (rc->touched_size[w] == rc->touched_capacity[w]) {
+    rc->touched_capacity[w] = rc->touched_capacity[w] ? rc->touched_capacity[w] * 2 : 1024;
+    rc->touched[w] = (long long*) realloc(rc->touched[w],
+        sizeof(long long) * rc->touched_capacity[w]);
+    if (rc->touched[w] == NULL) {
+      fprintf(stderr, "out of memory for the ready time counter\n");
+      exit(-1);
+    }
+  }
+  rc->touched[w][rc->touched_size[w]++] = offset;
+  rc_add(rc, w, offset);
+  rc->total[w]++;
+}
+
+size_t rc_drain(struct ready_count *rc, long long t) {
+  rc_advance(rc, t);
+  const long long from = rc->watermark >= rc->base ? rc->watermark : rc->base - 1;
+  const size_t count = rc->due + rc_upto(rc, t) - rc_upto(rc, from);
+  rc->due = 0;
+  if (t > rc->watermark) {
+    rc->watermark = t;
+  }
+  return count;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stddef.h>
+
+#define RC_WINDOW_BITS 20
+#define RC_WINDOW (1LL << RC_WINDOW_BITS)
+
+/*
+ * Counts Shuiyuan ready times without storing the bicycles. Every key pushed at time now lies in
+ * [now, now + RC_WINDOW), and a key at or below the current time is counted by the next drain no
+ * matter what, so only two windows of RC_WINDOW keys are kept exact, each as a Fenwick tree. Older
+ * keys are folded into due as time moves past them, and keys at or below watermark have already
+ * been drained.
+ */
+struct ready_count {
+  unsigned *tree[2];     // Fenwick trees over [base, base + RC_WINDOW) and the window after it
+  size_t total[2];       // keys held by each tree
+  long long *touched[2]; // offsets pushed into each tree, so it can be cleared in time proportional
+  size_t touched_size[2], touched_capacity[2];  // to its keys instead of its width
+  long long base;
+  long long watermark;
+  size_t due;
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        READY COUNT NEW
+ *
+ * Description: Creates an empty ready time counter.
+ *
+ * Arguments: None.
+ *
+ * Returns: A newly created struct ready_count instance.
+ *
+ * Notes: The caller is responsible for freeing the memory using rc_delete.
+ *********************************************************************************************************
+ */
+struct ready_count rc_new(void);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       READY COUNT DELETE
+ *
+ * Description: Frees the memory allocated for a ready time counter.
+ *
+ * Arguments: rc   Pointer to the counter to delete.
+ *
+ * Returns: void
+ *
+ * Notes: Sets all fields of the counter to 0 or NULL after freeing the memory.
+ *********************************************************************************************************
+ */
+void rc_delete(struct ready_count *rc);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        READY COUNT PUSH
+ *
+ * Description: Adds one ready time.
+ *
+ * Arguments: rc    Pointer to the counter.
+ *            now   The current time; never smaller than in an earlier call.
+ *            key   The ready time, in [now, now + RC_WINDOW).
+ *
+ * Returns: void
+ *
+ * Notes: O(log RC_WINDOW). Exits with an error message if key is outside the window.
+ *********************************************************************************************************
+ */
+void rc_push(struct ready_count *rc, long long now, long long key);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       READY COUNT DRAIN
+ *
+ * Description: Removes every ready time that is at most t.
+ *
+ * Arguments: rc   Pointer to the counter.
+ *            t    The current time; never smaller than in an earlier call.
+ *
+ * Returns: The number of ready times removed.
+ *
+ * Notes: Two prefix counts and a watermark update: O(log RC_WINDOW) no matter how many are removed.
+ *********************************************************************************************************
+ */
+size_t rc_drain(struct ready_count *rc, long long t);
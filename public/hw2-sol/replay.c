@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "rational.h"
+#include "dyadic.h"
+#include "bicycle.h"
+#include "cds.h"
+#include "fastio.h"
+#include "bpt.h"
+#include "report.h"
+#include "answer.h"
+#include "replay.h"
+
+/*
+ * What the two phases leave for the last pass: where a PARK ended up, how many bicycles a CLEAR or
+ * REARRANGE sent to Shuiyuan, or how long a MOVE took.
+ */
+union replay_outcome {
+  struct rational position;
+  size_t count;
+  long long distance;
+};
+
+struct replay_log {
+  const struct operation *operations;
+  const size_t *from;  // for MOVE, the slot the bicycle leaves
+  union replay_outcome *outcomes;
+  struct ps *pss;
+};
+
+/*
+ * An operation as one worker applies it. A worker names the bicycles on its slots by local ids, a
+ * fresh one each time a student's bicycle arrives on them, so its records need no room for all m
+ * students. erased and inserted are those ids, or -1 where the worker takes no part.
+ */
+struct replay_step {
+  size_t index;
+  int erased, inserted;
+};
+
+struct replay_worker {
+  const struct replay_log *log;
+  struct cds_array steps;     // struct replay_step, in log order
+  struct cds_array students;  // int, the student behind each local id
+  struct ps_record *records;  // by local id
+  int *leaving;               // room for every local id
+  struct cds_array leavers;   // students sent to Shuiyuan by this worker's slots, in log order
+  pthread_t thread;
+};
+
+static void replay_add_step(struct replay_worker *worker, size_t index, int erased, int inserted) {
+  const struct replay_step step = { .index = index, .erased = erased, .inserted = inserted };
+  if (ca_push_back(&worker->steps, &step) != 0) {
+    fprintf(stderr, "out of memory for the replay steps\n");
+    exit(-1);
+  }
+}
+
+/*
+ * Returns the local id for student s, whose bicycle is arriving on one of the worker's slots.
+ */
+static int replay_arrive(struct replay_worker *worker, int s) {
+  if (ca_push_back(&worker->students, &s) != 0) {
+    fprintf(stderr, "out of memory for the replay steps\n");
+    exit(-1);
+  }
+  return (int) ca_size(&worker->students) - 1;
+}
+
+static void *replay_run_worker(void *arg) {
+  struct replay_worker *worker = (struct replay_worker*) arg;
+  const struct replay_log *log = worker->log;
+  for (size_t k = 0; k < ca_size(&worker->steps); ++k) {
+    const struct replay_step *step = (const struct replay_step*) ca_get(&worker->steps, k);
+    const size_t i = step->index;
+    const struct operation *operation = &log->operations[i];
+    switch (operation->op) {
+      case PARK:
+        log->outcomes[i].position = d_to_rational(ps_insert(&log->pss[operation->b], step->inserted,
+            (size_t) operation->c, worker->records));
+        break;
+      case MOVE:
+        if (step->erased >= 0) {
+          ps_erase(&log->pss[log->from[i]], step->erased, worker->records);
+        }
+        if (step->inserted >= 0) {
+          ps_insert(&log->pss[operation->b], step->inserted, (size_t) operation->c, worker->records);
+        }
+        break;
+      case CLEAR:
+      case REARRANGE: {
+        struct ps *slot = &log->pss[operation->a];
+        const size_t count = operation->op == CLEAR ?
+            ps_clear(slot, worker->leaving) :
+            ps_rearrange(slot, worker->leaving, worker->records);
+        for (size_t k = 0; k < count; ++k) {
+          const int s = *(const int*) ca_get(&worker->students, (size_t) worker->leaving[k]);
+          if (ca_push_back(&worker->leavers, &s) != 0) {
+            fprintf(stderr, "out of memory for the bicycles sent to Shuiyuan\n");
+            exit(-1);
+          }
+        }
+        log->outcomes[i].count = count;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return NULL;
+}
+
+void handle_commands_replay(struct bicycle_pt *pt, struct fast_reader *in, struct fast_writer *out,
+    size_t q, size_t workers) {
+  if (workers < 1) {
+    workers = 1;
+  }
+  if (workers > REPLAY_MAX_WORKERS) {
+    workers = REPLAY_MAX_WORKERS;
+  }
+  struct operation *operations = (struct operation*) malloc(sizeof(struct operation) * q);
+  size_t *from = (size_t*) malloc(sizeof(size_t) * q);
+  union replay_outcome *outcomes = (union replay_outcome*) malloc(sizeof(union replay_outcome) * q);
+  // Where each student's bicycle was last parked, 0 before the first PARK as in records[s].slot,
+  // and its local id there, -1 before the first PARK
+  size_t *slot_of = (size_t*) calloc(pt->m, sizeof(size_t));
+  int *local_of = (int*) malloc(sizeof(int) * pt->m);
+  if (operations == NULL || from == NULL || outcomes == NULL || slot_of == NULL || local_of == NULL) {
+    fprintf(stderr, "out of memory for a log of %zu operations\n", q);
+    exit(-1);
+  }
+  for (size_t s = 0; s < pt->m; ++s) {
+    local_of[s] = -1;
+  }
+  struct replay_worker pool[REPLAY_MAX_WORKERS];
+  for (size_t w = 0; w < workers; ++w) {
+    pool[w].steps = ca_new(sizeof(struct replay_step));
+    pool[w].students = ca_new(sizeof(int));
+    pool[w].leavers = ca_new(sizeof(int));
+  }
+
+  // Each operation goes only to the workers holding the slots it touches
+  for (size_t i = 0; i < q; ++i) {
+    operations[i] = parse_operation(in);
+    const struct operation *operation = &operations[i];
+    switch (operation->op) {
+      case PARK: {
+        const int s = (int) operation->a;
+        struct replay_worker *target = &pool[operation->b % workers];
+        local_of[s] = replay_arrive(target, s);
+        replay_add_step(target, i, -1, local_of[s]);
+        slot_of[s] = (size_t) operation->b;
+        break;
+      }
+      case MOVE: {
+        const int s = (int) operation->a;
+        const size_t x = slot_of[s], y = (size_t) operation->b;
+        from[i] = x;
+        if (x == y) {
+          break;
+        }
+        struct replay_worker *source = &pool[x % workers], *target = &pool[y % workers];
+        if (source == target) {
+          replay_add_step(target, i, local_of[s], local_of[s]);
+        } else {
+          replay_add_step(source, i, local_of[s], -1);
+          local_of[s] = replay_arrive(target, s);
+          replay_add_step(target, i, -1, local_of[s]);
+        }
+        slot_of[s] = y;
+        break;
+      }
+      case CLEAR:
+      case REARRANGE:
+        replay_add_step(&pool[operation->a % workers], i, -1, -1);
+        break;
+      default:
+        break;
+    }
+  }
+  free(slot_of);
+  free(local_of);
+
+  const struct replay_log log = {
+    .operations = operations,
+    .from = from,
+    .outcomes = outcomes,
+    .pss = pt->pss};
+  for (size_t w = 0; w < workers; ++w) {
+    // A slot never holds more bicycles than arrived on it, so leaving fits in one entry per id
+    const size_t ids = ca_size(&pool[w].students);
+    pool[w].log = &log;
+    pool[w].records = (struct ps_record*) calloc(ids + 1, sizeof(struct ps_record));
+    pool[w].leaving = (int*) malloc(sizeof(int) * (ids + 1));
+    if (pool[w].records == NULL || pool[w].leaving == NULL) {
+      fprintf(stderr, "out of memory for %zu bicycles of replay worker %zu\n", ids, w);
+      exit(-1);
+    }
+    if (pthread_create(&pool[w].thread, NULL, replay_run_worker, &pool[w]) != 0) {
+      fprintf(stderr, "cannot start replay worker %zu\n", w);
+      exit(-1);
+    }
+  }
+
+  // Meanwhile every MOVE distance is resolved here, REBUILDs applied in log order. Their LCAs are
+  // lookups in the sparse table; the workers never write the outcome of a MOVE
+  for (size_t i = 0; i < q; ++i) {
+    const struct operation *operation = &operations[i];
+    if (operation->op == REBUILD) {
+      bpt_rebuild(pt, (size_t) operation->a, (size_t) operation->b, operation->c);
+    } else if (operation->op == MOVE) {
+      const size_t y = (size_t) operation->b;
+      outcomes[i].distance = from[i] != y ? bpt_find_dis(pt, from[i], y) : 0;
+    }
+  }
+
+  for (size_t w = 0; w < workers; ++w) {
+    pthread_join(pool[w].thread, NULL);
+  }
+
+  // Shuiyuan is shared by all slots, so it is replayed here in order
+  size_t cursor[REPLAY_MAX_WORKERS] = {0};
+  for (size_t i = 0; i < q; ++i) {
+    const struct operation *operation = &operations[i];
+    switch (operation->op) {
+      case PARK: {
+        const struct park_result result = {
+          .s = (int) operation->a,
+          .x = (size_t) operation->b,
+          .position = outcomes[i].position};
+        rp_park(out, &result);
+        break;
+      }
+      case MOVE: {
+        const struct move_result result = {
+          .s = (int) operation->a,
+          .y = (size_t) operation->b,
+          .t = outcomes[i].distance};
+        rp_move(out, &result);
+        break;
+      }
+      case CLEAR:
+      case REARRANGE: {
+        const size_t x = (size_t) operation->a, w = x % workers;
+        for (size_t k = 0; k < outcomes[i].count; ++k) {
+          const int owner = *(const int*) ca_get(&pool[w].leavers, cursor[w]++);
+          bpt_send_to_shuiyuan(pt, owner, operation->b);
+        }
+        if (operation->op == REARRANGE) {
+          const struct rearrange_result result = { .x = x, .count = outcomes[i].count };
+          rp_rearrange(out, &result);
+        }
+        break;
+      }
+      case FETCH: {
+        const struct fetch_result result = bpt_fetch(pt, operation->a);
+        rp_fetch(out, &result);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  for (size_t w = 0; w < workers; ++w) {
+    free(pool[w].records);
+    free(pool[w].leaving);
+    ca_delete(&pool[w].steps);
+    ca_delete(&pool[w].students);
+    ca_delete(&pool[w].leavers);
+  }
+  free(operations);
+  free(from);
+  free(outcomes);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "fastio.h"
+#include "bpt.h"
+
+#define REPLAY_MAX_WORKERS 64
+#ifndef REPLAY_WORKERS
+#define REPLAY_WORKERS 0  // 0: one worker per online processor
+#endif
+
+/*
+ *********************************************************************************************************
+ *
+ *                                    HANDLE COMMANDS REPLAY
+ *
+ * Description: Processes a whole operation log like handle_commands, simulating slots in parallel.
+ *
+ * Arguments: pt        Pointer to the bicycle parking tree.
+ *            in        The reader positioned at the first operation.
+ *            out       The writer that receives one result per PARK, MOVE, REARRANGE and FETCH.
+ *            q         The number of operations to process.
+ *            workers   The number of simulation threads, clamped to 1 ... REPLAY_MAX_WORKERS.
+ *
+ * Returns: void
+ *
+ * Notes: A slot's bicycles depend only on the operations on that slot, and the slot a MOVE leaves
+ *        only on the earlier PARKs and MOVEs of the same student. So the log is parsed and those
+ *        slots found in one pass that also hands each operation to the workers it touches: slot x
+ *        belongs to worker x % workers, and a MOVE between two workers is an erase on one and an
+ *        insert on the other. Each worker then walks only its own operations, naming bicycles by
+ *        ids of its own so that its records grow with the arrivals on its slots rather than with m.
+ *        The workers record PARK positions, REARRANGE counts and who each CLEAR and REARRANGE sends
+ *        to Shuiyuan. Since every MOVE's endpoints are known up front, the calling thread meanwhile
+ *        resolves all distances in one sweep that applies the REBUILDs in log order. A last serial
+ *        pass replays Shuiyuan and FETCH and writes the results, so the output is that of
+ *        handle_commands. Holds the whole log in memory, about 56 bytes per operation and 16 per
+ *        step a worker takes, plus 24 bytes per bicycle arriving on a worker's slots.
+ *        pt->records is left stale.
+ *********************************************************************************************************
+ */
+void handle_commands_replay(struct bicycle_pt *pt, struct fast_reader *in, struct fast_writer *out,
+    size_t q, size_t workers);
@@ -0,0 +1,63 @@
+#include "fastio.h"
+#include "bpt.h"
+#include "report.h"
+
+void rp_park(struct fast_writer *out, const struct park_result *result) {
+  if (out->binary) {
+    fw_put_op(out, PARK);
+    fw_put_ll(out, result->s);
+    fw_put_ll(out, (long long) result->x);
+    fw_put_fraction(out, result->position.p, result->position.q);
+    return;
+  }
+  fw_put_ll(out, result->s);
+  fw_put_str(out, " parked at (");
+  fw_put_ll(out, (long long) result->x);
+  fw_put_str(out, ", ");
+  fw_put_fraction(out, result->position.p, result->position.q);
+  fw_put_str(out, ").\n");
+}
+
+void rp_move(struct fast_writer *out, const struct move_result *result) {
+  if (out->binary) {
+    fw_put_op(out, MOVE);
+    fw_put_ll(out, result->s);
+    fw_put_ll(out, (long long) result->y);
+    fw_put_ll(out, result->t);
+    return;
+  }
+  fw_put_ll(out, result->s);
+  fw_put_str(out, " moved to ");
+  fw_put_ll(out, (long long) result->y);
+  fw_put_str(out, " in ");
+  fw_put_ll(out, result->t);
+  fw_put_str(out, " seconds.\n");
+}
+
+void rp_rearrange(struct fast_writer *out, const struct rearrange_result *result) {
+  if (out->binary) {
+    fw_put_op(out, REARRANGE);
+    fw_put_ll(out, (long long) result->x);
+    fw_put_ll(out, (long long) result->count);
+    return;
+  }
+  fw_put_str(out, "Rearranged ");
+  fw_put_ll(out, (long long) result->count);
+  fw_put_str(out, " bicycles in ");
+  fw_put_ll(out, (long long) result->x);
+  fw_put_str(out, ".\n");
+}
+
+void rp_fetch(struct fast_writer *out, const struct fetch_result *result) {
+  if (out->binary) {
+    fw_put_op(out, FETCH);
+    fw_put_ll(out, result->t);
+    fw_put_ll(out, (long long) result->count);
+    return;
+  }
+  fw_put_str(out, "At ");
+  fw_put_ll(out, result->t);
+  fw_put_str(out, ", ");
+  fw_put_ll(out, (long long) result->count);
+  fw_put_str(out, " bikes was fetched.\n");
+}
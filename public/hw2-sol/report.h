@@ -0,0 +1,78 @@
+#pragma once
+
+#include "fastio.h"
+#include "bpt.h"
+
+/*
+ * Front-end formatting of operation results. Text writers get the exact lines the checker expects;
+ * binary writers get the result stream records described in fastio.h. CLEAR and REBUILD report
+ * nothing.
+ */
+
+/*
+ *********************************************************************************************************
+ *
+ *                                         REPORT PARK
+ *
+ * Description: Writes "s parked at (x, p/q)." for a PARK result.
+ *
+ * Arguments: out      Pointer to the writer.
+ *            result   The result of bpt_park.
+ *
+ * Returns: void
+ *
+ * Notes: Integer positions are written without "/q".
+ *********************************************************************************************************
+ */
+void rp_park(struct fast_writer *out, const struct park_result *result);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                         REPORT MOVE
+ *
+ * Description: Writes "s moved to y in t seconds." for a MOVE result.
+ *
+ * Arguments: out      Pointer to the writer.
+ *            result   The result of bpt_move.
+ *
+ * Returns: void
+ *
+ * Notes: None.
+ *********************************************************************************************************
+ */
+void rp_move(struct fast_writer *out, const struct move_result *result);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       REPORT REARRANGE
+ *
+ * Description: Writes "Rearranged count bicycles in x." for a REARRANGE result.
+ *
+ * Arguments: out      Pointer to the writer.
+ *            result   The result of bpt_rearrange.
+ *
+ * Returns: void
+ *
+ * Notes: None.
+ *********************************************************************************************************
+ */
+void rp_rearrange(struct fast_writer *out, const struct rearrange_result *result);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                         REPORT FETCH
+ *
+ * Description: Writes "At t, count bikes was fetched." for a FETCH result.
+ *
+ * Arguments: out      Pointer to the writer.
+ *            result   The result of bpt_fetch.
+ *
+ * Returns: void
+ *
+ * Notes: The wording, "bikes was", is the one the judge's sample outputs use.
+ *********************************************************************************************************
+ */
+void rp_fetch(struct fast_writer *out, const struct fetch_result *result);
@@ -0,0 +1,60 @@
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "spsc_ring.h"
+
+struct spsc_ring sr_new(size_t element_size, size_t capacity) {
+  size_t rounded = 1;
+  while (rounded < capacity) {
+    rounded *= 2;
+  }
+  struct spsc_ring new_ring = {
+    .data = (char*) malloc(element_size * rounded),
+    .element_size = element_size,
+    .mask = rounded - 1,
+    .tail_seen = 0,
+    .head_seen = 0};
+  if (new_ring.data == NULL) {
+    fprintf(stderr, "out of memory for a ring of %zu elements\n", rounded);
+    exit(-1);
+  }
+  atomic_init(&new_ring.head, 0);
+  atomic_init(&new_ring.tail, 0);
+  return new_ring;
+}
+
+void sr_delete(struct spsc_ring *ring) {
+  free(ring->data);
+  ring->data = NULL;
+  ring->element_size = ring->mask = 0;
+  atomic_store(&ring->head, 0);
+  atomic_store(&ring->tail, 0);
+  ring->tail_seen = ring->head_seen = 0;
+}
+
+void sr_push(struct spsc_ring *ring, const void *element) {
+  const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  while (head - ring->tail_seen > ring->mask) {
+    ring->tail_seen = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - ring->tail_seen > ring->mask) {
+      sched_yield();
+    }
+  }
+  memcpy(ring->data + (head & ring->mask) * ring->element_size, element, ring->element_size);
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void sr_pop(struct spsc_ring *ring, void *element) {
+  const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  while (tail == ring->head_seen) {
+    ring->head_seen = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail == ring->head_seen) {
+      sched_yield();
+    }
+  }
+  memcpy(element, ring->data + (tail & ring->mask) * ring->element_size, ring->element_size);
+  atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define SR_CACHE_LINE 64
+
+/*
+ * A bounded queue between exactly one producer thread and one consumer thread, with no lock. The
+ * producer owns head and the consumer owns tail; each publishes its index with a release store and
+ * reads the other's with an acquire load. Each side also keeps its own copy of the other index and
+ * reloads it only when the ring looks full or empty, so most pushes and pops touch no shared line.
+ * The indices grow without wrapping and the capacity is a power of two, so a slot is index & mask.
+ */
+struct spsc_ring {
+  char *data;
+  size_t element_size, mask;
+  _Alignas(SR_CACHE_LINE) atomic_size_t head;  // next slot to fill, written by the producer
+  size_t tail_seen;                            // the producer's copy of tail
+  _Alignas(SR_CACHE_LINE) atomic_size_t tail;  // next slot to empty, written by the consumer
+  size_t head_seen;                            // the consumer's copy of head
+};
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        SPSC RING NEW
+ *
+ * Description: Creates an empty ring.
+ *
+ * Arguments: element_size   The size of each element in bytes.
+ *            capacity       The least number of elements the ring holds before a push waits.
+ *
+ * Returns: A newly created struct spsc_ring instance.
+ *
+ * Notes: The capacity is rounded up to a power of two. Create the ring before starting the threads
+ *        that use it, and do not copy it afterwards. The caller is responsible for freeing the
+ *        memory using sr_delete.
+ *********************************************************************************************************
+ */
+struct spsc_ring sr_new(size_t element_size, size_t capacity);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                       SPSC RING DELETE
+ *
+ * Description: Frees the memory held by a ring.
+ *
+ * Arguments: ring   Pointer to the ring to delete.
+ *
+ * Returns: void
+ *
+ * Notes: Only once both threads are done with it. Sets all fields of the ring to 0 or NULL.
+ *********************************************************************************************************
+ */
+void sr_delete(struct spsc_ring *ring);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                        SPSC RING PUSH
+ *
+ * Description: Copies an element to the back of the ring.
+ *
+ * Arguments: ring      Pointer to the ring.
+ *            element   Pointer to the element to copy.
+ *
+ * Returns: void
+ *
+ * Notes: Producer thread only. Yields the processor while the ring is full.
+ *********************************************************************************************************
+ */
+void sr_push(struct spsc_ring *ring, const void *element);
+
+/*
+ *********************************************************************************************************
+ *
+ *                                         SPSC RING POP
+ *
+ * Description: Moves the element at the front of the ring out.
+ *
+ * Arguments: ring      Pointer to the ring.
+ *            element   Receives the element.
+ *
+ * Returns: void
+ *
+ * Notes: Consumer thread only. Yields the processor while the ring is empty.
+ *********************************************************************************************************
+ */
+void sr_pop(struct spsc_ring *ring, void *element);